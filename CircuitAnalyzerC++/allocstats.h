@@ -0,0 +1,13 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - allocation counter
+ *
+ * allocstats.cpp replaces the global operator new/delete, including the
+ * aligned forms, with thin malloc/free wrappers that count calls, so
+ * benchmarks and the frame overlay can report heap allocations. Link it
+ * into every binary.
+ ********************************************************************/
+
+#pragma once
+
+// number of operator new calls since start-up (all threads)
+long long AllocationCount();
@@ -0,0 +1,221 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - background analysis worker
+ ********************************************************************/
+
+#include "analysisworker.h"
+#include "parallel.h"
+#include "spscqueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+SpscQueue<std::shared_ptr<const AnalysisSnapshot>, 8> analysisJobs;     // UI -> worker
+SpscQueue<std::shared_ptr<const AnalysisReport>, 8> analysisResults;    // worker -> UI
+std::thread analysisThread;
+std::atomic<bool> analysisStop(false);
+std::atomic<long long> analysisPosted(0);      // serial of the newest snapshot
+std::atomic<long long> analysisReported(0);    // serial of the newest report pushed
+std::atomic<long long> analysisDone(0);        // Monte Carlo samples of the running job
+std::atomic<long long> analysisTotal(0);
+long long analysisNextSerial = 0;              // UI thread only
+// only for sleeping while there is nothing to do; the queues need no lock
+std::mutex analysisMutex;
+std::condition_variable analysisWake;
+
+// ---------------------- Jobs -------------------------
+
+std::shared_ptr<AnalysisSnapshot> SnapshotCircuit(long long monteCarloSamples) {
+    GetAnalysis();   // folds any pending round-off resync into the sums
+    auto snap = std::make_shared<AnalysisSnapshot>();
+    snap->revision = circuitRevision;
+    snap->freqHz = analysisFrequencyHz;
+    snap->series = seriesSums;
+    snap->parallel = parallelSums;
+    snap->seriesCount = (int)seriesCircuit.size();
+    snap->parallelCount = (int)parallelCircuit.size();
+    snap->components = componentsData;
+    snap->monteCarlo.samples = monteCarloSamples;
+    return snap;
+}
+
+// an imported general network: Zin, its spread and sensitivities by nodal analysis
+bool RunNetworkJob(const AnalysisSnapshot& snap, AnalysisReport& report,
+    const std::function<bool()>& keepGoing, std::chrono::steady_clock::time_point t0) {
+    const Network& net = *snap.network;
+    report.hasNetwork = true;
+    int toleranced = 0;
+    for (const NetElement& e : net.elements) {
+        if (e.comp.tolerance > 0.0 && e.comp.value != 0.0) toleranced++;
+    }
+    analysisDone.store(0);
+    analysisTotal.store(toleranced > 0 ? snap.monteCarlo.samples : 0);
+    if (toleranced > 0) {
+        MonteCarloSettings mc = snap.monteCarlo;
+        mc.freqHz = snap.freqHz;
+        mc.threads = std::max(1, HardwareThreads() - 1);
+        mc.progress = [&keepGoing](long long done) {
+            analysisDone.store(done, std::memory_order_relaxed);
+            return keepGoing();
+        };
+        if (RunNetworkMonteCarlo(net, mc, report.monteCarlo.combined)) {
+            report.monteCarlo.samples = mc.samples;
+            report.monteCarlo.toleranced = toleranced;
+        }
+    }
+    if (!keepGoing()) return false;
+
+    report.networkSolved = NetworkSensitivities(net, snap.freqHz, report.sensitivity, report.networkZ);
+    report.sensitivityZ = std::abs(report.networkZ);
+    report.sensitivityCount = (int)report.sensitivity.size();
+    if (report.sensitivity.size() > (size_t)ANALYSIS_SENS_ROWS) {
+        report.sensitivity.resize(ANALYSIS_SENS_ROWS);
+        report.sensitivity.shrink_to_fit();
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+bool RunAnalysisJob(const AnalysisSnapshot& snap, AnalysisReport& report,
+    const std::function<bool()>& keepGoing) {
+    auto t0 = std::chrono::steady_clock::now();
+    report = AnalysisReport();
+    report.serial = snap.serial;
+    report.revision = snap.revision;
+    report.freqHz = snap.freqHz;
+    report.seriesCount = snap.seriesCount;
+    report.parallelCount = snap.parallelCount;
+    report.analysis = AnalyzeSums(snap.series, snap.parallel, snap.freqHz);
+    report.analysis.revision = snap.revision;
+
+    if (snap.network) return RunNetworkJob(snap, report, keepGoing, t0);
+
+    // the Monte Carlo pass dominates; it is skipped when nothing varies
+    bool anyToleranced = false;
+    for (const Component& c : snap.components) {
+        if (c.tolerance > 0.0 && c.value != 0.0) { anyToleranced = true; break; }
+    }
+    analysisDone.store(0);
+    analysisTotal.store(anyToleranced ? snap.monteCarlo.samples : 0);
+    if (anyToleranced) {
+        MonteCarloSettings mc = snap.monteCarlo;
+        mc.freqHz = snap.freqHz;
+        mc.threads = std::max(1, HardwareThreads() - 1);   // one core stays with the UI
+        mc.progress = [&keepGoing](long long done) {
+            analysisDone.store(done, std::memory_order_relaxed);
+            return keepGoing();
+        };
+        if (!RunMonteCarlo(snap.components, mc, report.monteCarlo)) return false;
+    }
+    if (!keepGoing()) return false;
+
+    report.sensitivityZ = CircuitSensitivities(snap.components, snap.freqHz, report.sensitivity);
+    report.sensitivityCount = (int)report.sensitivity.size();
+    if (report.sensitivity.size() > (size_t)ANALYSIS_SENS_ROWS) {
+        report.sensitivity.resize(ANALYSIS_SENS_ROWS);
+        report.sensitivity.shrink_to_fit();
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+// ---------------------- Worker Thread -------------------------
+
+void AnalysisWorkerMain() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(analysisMutex);
+            analysisWake.wait(lock, [] { return analysisStop.load() || !analysisJobs.Empty(); });
+        }
+        if (analysisStop.load()) return;
+
+        // only the newest queued snapshot is worth running
+        std::shared_ptr<const AnalysisSnapshot> job, next;
+        while (analysisJobs.TryPop(next)) job = std::move(next);
+        if (!job) continue;
+
+        long long serial = job->serial;
+        auto keepGoing = [serial] {
+            return !analysisStop.load(std::memory_order_relaxed) &&
+                analysisPosted.load(std::memory_order_relaxed) == serial;
+        };
+        auto report = std::make_shared<AnalysisReport>();
+        if (!RunAnalysisJob(*job, *report, keepGoing)) continue;   // stale: a newer job is queued
+        job.reset();
+
+        std::shared_ptr<const AnalysisReport> done = report;
+        // the UI drains every frame, so a full queue only lasts a frame
+        while (!analysisResults.TryPush(done)) {
+            if (analysisStop.load()) return;
+            std::this_thread::yield();
+        }
+        analysisReported.store(serial, std::memory_order_release);
+    }
+}
+
+void StartAnalysisWorker() {
+    if (analysisThread.joinable()) return;
+    analysisStop.store(false);
+    analysisThread = std::thread(AnalysisWorkerMain);
+}
+
+void StopAnalysisWorker() {
+    if (!analysisThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        analysisStop.store(true);
+    }
+    analysisWake.notify_one();
+    analysisThread.join();
+    std::shared_ptr<const AnalysisSnapshot> job;
+    while (analysisJobs.TryPop(job)) {}
+    std::shared_ptr<const AnalysisReport> report;
+    while (analysisResults.TryPop(report)) {}
+    analysisReported.store(analysisPosted.load());
+}
+
+bool AnalysisWorkerRunning() {
+    return analysisThread.joinable();
+}
+
+// ---------------------- UI Side -------------------------
+
+bool PostAnalysis(std::shared_ptr<AnalysisSnapshot> snap) {
+    if (!analysisThread.joinable()) return false;
+    snap->serial = ++analysisNextSerial;
+    // published before the push, so the running job sees it is stale at once
+    analysisPosted.store(snap->serial);
+    if (!analysisJobs.TryPush(std::move(snap))) return false;
+    {
+        // taken so the wake-up cannot slip in between the worker's check and its wait
+        std::lock_guard<std::mutex> lock(analysisMutex);
+    }
+    analysisWake.notify_one();
+    return true;
+}
+
+bool PollAnalysis(std::shared_ptr<const AnalysisReport>& latest) {
+    bool changed = false;
+    std::shared_ptr<const AnalysisReport> r;
+    while (analysisResults.TryPop(r)) {
+        latest = std::move(r);
+        changed = true;
+    }
+    return changed;
+}
+
+bool AnalysisBusy() {
+    return analysisReported.load(std::memory_order_acquire) != analysisPosted.load(std::memory_order_acquire);
+}
+
+double AnalysisProgress() {
+    long long total = analysisTotal.load(std::memory_order_relaxed);
+    if (total <= 0) return 0.0;
+    return std::min(1.0, (double)analysisDone.load(std::memory_order_relaxed) / (double)total);
+}
+
+void WaitAnalysisIdle() {
+    while (analysisThread.joinable() && AnalysisBusy()) std::this_thread::yield();
+}
@@ -0,0 +1,77 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - background analysis worker
+ *
+ * The UI thread takes an immutable AnalysisSnapshot of the circuit (the
+ * persistent component store is shared, not copied) and posts it; one worker thread turns snapshots into AnalysisReports
+ * (R/|Z|, Monte Carlo spread, ranked sensitivities). Both directions are
+ * lock-free single-producer/single-consumer queues; the mutex below is
+ * only used to let an idle worker sleep. Posting a snapshot makes every
+ * older job stale: the worker skips queued ones and cancels the running
+ * one at its next Monte Carlo chunk, so it is never more than one chunk
+ * behind the newest circuit.
+ ********************************************************************/
+
+#pragma once
+
+#include "circuitcore.h"
+#include "mna.h"
+#include "montecarlo.h"
+#include "sensitivity.h"
+#include <memory>
+#include <vector>
+
+struct AnalysisSnapshot {
+    long long serial = 0;        // set by PostAnalysis
+    int revision = -1;           // circuitRevision it was taken at
+    double freqHz = 50.0;
+    CircuitSums series, parallel;
+    int seriesCount = 0, parallelCount = 0;
+    ComponentStore components;           // shares componentsData's nodes
+    MonteCarloSettings monteCarlo;       // freqHz and threads are filled in
+    // an imported deck the lists cannot describe (see IsSeriesParallelNetwork);
+    // when set the report is its input impedance, not the lists' sums
+    std::shared_ptr<const Network> network;
+};
+
+// sensitivity rows kept per report (the table shows fewer)
+const int ANALYSIS_SENS_ROWS = 32;
+
+struct AnalysisReport {
+    long long serial = 0;
+    int revision = -1;
+    double freqHz = 0.0;
+    int seriesCount = 0, parallelCount = 0;
+    AnalysisResult analysis;
+    bool hasNetwork = false;                     // from snapshot.network: networkZ is the result
+    bool networkSolved = false;                  // false if its nodal matrix is singular
+    cd networkZ = 0.0;
+    MonteCarloResult monteCarlo;                 // only .combined for a network
+    std::vector<SensitivityEntry> sensitivity;   // top ANALYSIS_SENS_ROWS, ranked
+    int sensitivityCount = 0;                    // entries before truncation
+    double sensitivityZ = 0.0;
+    double seconds = 0.0;                        // worker time for this job
+};
+
+// the current circuit; O(1), the component store is shared, not copied
+std::shared_ptr<AnalysisSnapshot> SnapshotCircuit(long long monteCarloSamples);
+
+// the whole job on the calling thread; false if `keepGoing` returned false
+bool RunAnalysisJob(const AnalysisSnapshot& snap, AnalysisReport& report,
+    const std::function<bool()>& keepGoing);
+
+void StartAnalysisWorker();
+// cancels the running job and joins the thread
+void StopAnalysisWorker();
+bool AnalysisWorkerRunning();
+
+// queues a snapshot and makes every earlier one stale; false if the job
+// queue is full (post it again next frame)
+bool PostAnalysis(std::shared_ptr<AnalysisSnapshot> snap);
+// drains finished reports into `latest`; true if it changed
+bool PollAnalysis(std::shared_ptr<const AnalysisReport>& latest);
+// the newest posted snapshot has not been reported yet
+bool AnalysisBusy();
+// progress of the running job in [0, 1]
+double AnalysisProgress();
+// blocks until the newest posted snapshot is reported (benchmarks, tests)
+void WaitAnalysisIdle();
@@ -0,0 +1,230 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - micro-benchmarks
+ ********************************************************************/
+
+#include "bench.h"
+#include "allocstats.h"
+#include "circuitcore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// results of every op land here so the optimizer cannot drop them
+static volatile double benchSink = 0.0;
+
+static std::mt19937 benchRng(12345);
+static std::vector<int> benchIds;
+static size_t benchCursor = 0;
+static std::vector<ComponentSpec> benchSpecs;
+
+static double NowNs() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void BuildBenchCircuit(int size) {
+    ClearCircuit();
+    std::uniform_int_distribution<int> type(0, 2);
+    std::uniform_real_distribution<double> mant(1.0, 10.0);
+    const double scale[3] = { 1e3, 1e-6, 1e-3 };   // Ohm, F, H
+    for (int i = 0; i < size; ++i) {
+        int t = type(benchRng);
+        AppendComponent((ComponentType)t, mant(benchRng) * scale[t],
+            (i & 1) ? CircuitType::PARALLEL : CircuitType::SERIES);
+    }
+}
+
+// ids 1..size in random order, consumed by the lookup/remove cases
+static void ShuffleBenchIds(int size) {
+    benchIds.resize(size);
+    for (int i = 0; i < size; ++i) benchIds[i] = i + 1;
+    std::shuffle(benchIds.begin(), benchIds.end(), benchRng);
+    benchCursor = 0;
+}
+
+static int NextBenchId() {
+    if (benchCursor == benchIds.size()) benchCursor = 0;
+    return benchIds[benchCursor++];
+}
+
+// 1000 alternating series/parallel resistors for the bulk add case
+static void FillBenchSpecs() {
+    benchSpecs.clear();
+    for (int i = 0; i < 1000; ++i) {
+        benchSpecs.push_back({ ComponentType::RESISTOR, 100.0 + i, (i & 1) ? CircuitType::PARALLEL : CircuitType::SERIES });
+    }
+}
+
+void AddCoreBenchCases(std::vector<BenchCase>& cases) {
+    auto circuit = [](int n) -> long long { BuildBenchCircuit(n); return 0; };
+    auto shuffled = [](int n) -> long long { BuildBenchCircuit(n); ShuffleBenchIds(n); return 0; };
+
+    cases.push_back({ "FindComponent", shuffled,
+        [] { benchSink = FindComponent(NextBenchId())->value; } });
+
+    // one journaled component added and taken back by undo, so every op
+    // runs on a circuit of the labelled size
+    cases.push_back({ "AddComponentUndo", circuit,
+        [] {
+            AddComponent(ComponentType::RESISTOR, 100.0, CircuitType::SERIES);
+            Undo();
+        } });
+
+    // each op removes a different live component, so the state supports n ops
+    cases.push_back({ "RemoveComponent",
+        [](int n) -> long long { BuildBenchCircuit(n); ShuffleBenchIds(n); return n; },
+        [] { RemoveComponent(NextBenchId()); } });
+
+    // 1000 parts as one transaction, then its undo
+    cases.push_back({ "AddComponentsUndo",
+        [](int n) -> long long { BuildBenchCircuit(n); FillBenchSpecs(); return 0; },
+        [] {
+            AddComponents(benchSpecs.data(), benchSpecs.size());
+            Undo();
+        } });
+
+    // 1000 parts from the middle as one edit, then its undo
+    cases.push_back({ "RemoveRangeUndo", circuit,
+        [] {
+            int first = nextId / 2;
+            RemoveComponents(first, first + 999);
+            Undo();
+        } });
+
+    // a random (mostly old) part removed and put back by undo
+    cases.push_back({ "RemoveUndo", shuffled,
+        [] {
+            RemoveComponent(NextBenchId());
+            Undo();
+        } });
+
+    // undo of the newest edit and its redo, circuit size stays constant
+    cases.push_back({ "UndoRedo",
+        [](int n) -> long long {
+            BuildBenchCircuit(n);
+            AddComponent(ComponentType::CAPACITOR, 1e-6, CircuitType::PARALLEL);
+            return 0;
+        },
+        [] { Undo(); Redo(); } });
+
+    cases.push_back({ "CalcSeries", circuit,
+        [] { benchSink = CalcSeries(seriesCircuit); } });
+    cases.push_back({ "CalcParallel", circuit,
+        [] { benchSink = CalcParallel(parallelCircuit); } });
+    cases.push_back({ "CalcSeriesImpedance", circuit,
+        [] { benchSink = CalcSeriesImpedance(seriesCircuit, analysisFrequencyHz); } });
+    cases.push_back({ "CalcParallelImpedance", circuit,
+        [] { benchSink = CalcParallelImpedance(parallelCircuit, analysisFrequencyHz); } });
+
+    // what the GUI pays after an edit: cache miss, totals from the running sums
+    cases.push_back({ "GetAnalysis", circuit,
+        [] { circuitRevision++; benchSink = GetAnalysis().combinedZ; } });
+
+    // full re-derivation from the columns (the periodic resync)
+    cases.push_back({ "ResyncColumns", circuit,
+        [] {
+            circuitRevision++;
+            EnsureColumns();
+            benchSink = ReduceColumns(seriesColumns).sum[0] + ReduceColumns(parallelColumns).sum[0];
+        } });
+}
+
+static std::vector<int> ParseSizes(const char* s) {
+    std::vector<int> sizes;
+    while (*s) {
+        char* end = nullptr;
+        long v = std::strtol(s, &end, 10);
+        if (end == s) break;
+        if (v > 0) sizes.push_back((int)v);
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return sizes;
+}
+
+static double Percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static void RunCase(const BenchCase& bc, int size, double budgetNs) {
+    long long limit = bc.setup(size);
+
+    // one warm-up op (lazy rebuilds, cold caches), then double the batch
+    // size until one batch takes >= 2 us or the state runs out
+    const double minBatchNs = 2000.0;
+    long long batch = 1, done = 0;
+    if (limit != 1) { bc.op(); done = 1; }
+    for (;;) {
+        if (limit && done + batch > limit) break;
+        double t0 = NowNs();
+        for (long long i = 0; i < batch; ++i) bc.op();
+        double dt = NowNs() - t0;
+        done += batch;
+        if (dt >= minBatchNs || batch >= (1LL << 20)) break;
+        batch *= 2;
+    }
+    // calibration used up part of a consumable state: start it afresh
+    if (limit) { limit = bc.setup(size); done = 0; }
+
+    std::vector<double> samples;
+    samples.reserve(1 << 16);   // before the allocation counter is read
+    long long ops = 0;
+    double total = 0.0;
+    long long allocs0 = AllocationCount();
+    double start = NowNs();
+    while (samples.size() < samples.capacity()) {
+        if (limit) {
+            long long left = limit - done - ops;
+            if (left <= 0) break;
+            if (batch > left) batch = left;
+        }
+        double t0 = NowNs();
+        for (long long i = 0; i < batch; ++i) bc.op();
+        double dt = NowNs() - t0;
+        samples.push_back(dt / batch);
+        ops += batch;
+        total += dt;
+        if (NowNs() - start >= budgetNs) break;
+    }
+    long long allocs = AllocationCount() - allocs0;
+
+    if (ops == 0) return;
+    double p50 = Percentile(samples, 0.50);
+    double p99 = Percentile(samples, 0.99);
+    std::printf("{\"bench\":\"%s\",\"size\":%d,\"ops\":%lld,\"ns_per_op\":%.2f,"
+        "\"allocs_per_op\":%.3f,\"p50_ns\":%.2f,\"p99_ns\":%.2f}\n",
+        bc.name.c_str(), size, ops, total / ops, (double)allocs / ops, p50, p99);
+    std::fflush(stdout);
+}
+
+int RunBenchmarks(int argc, char** argv, const std::vector<BenchCase>& cases) {
+    std::vector<int> sizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    double budgetMs = 200.0;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (std::strcmp(a, "--sizes") == 0 && i + 1 < argc) sizes = ParseSizes(argv[++i]);
+        else if (std::strcmp(a, "--budget-ms") == 0 && i + 1 < argc) budgetMs = std::atof(argv[++i]);
+        else if (std::strcmp(a, "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+    }
+    if (sizes.empty() || budgetMs <= 0.0) {
+        std::fprintf(stderr, "bench: bad --sizes or --budget-ms\n");
+        return 1;
+    }
+
+    for (const BenchCase& bc : cases) {
+        if (!filter.empty() && bc.name.find(filter) == std::string::npos) continue;
+        for (int size : sizes) {
+            if (size > bc.maxSize) continue;
+            RunCase(bc, size, budgetMs * 1e6);
+        }
+    }
+    ClearCircuit();
+    return 0;
+}
@@ -0,0 +1,36 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - micro-benchmarks
+ *
+ * Every case is run at each circuit size (10 .. 1M components by
+ * default). Operations are timed in batches sized to take a few
+ * microseconds; each result is one JSON object per line on stdout:
+ *
+ *   {"bench":"FindComponent","size":1000,"ops":..,"ns_per_op":..,
+ *    "allocs_per_op":..,"p50_ns":..,"p99_ns":..}
+ *
+ * p50/p99 are percentiles of the per-batch mean, in ns per operation.
+ ********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchCase {
+    std::string name;
+    // untimed: builds the state for one size, returns how many ops that
+    // state supports (0 = unlimited)
+    std::function<long long(int size)> setup;
+    std::function<void()> op;       // one timed operation
+    int maxSize = 1000000;          // larger sizes are skipped
+};
+
+// `size` components with random type/value, half series and half parallel
+void BuildBenchCircuit(int size);
+
+void AddCoreBenchCases(std::vector<BenchCase>& cases);
+
+// "[--sizes 10,100,...] [--budget-ms N] [--filter text]"; unknown
+// arguments are ignored so the GUI can pass its own argv
+int RunBenchmarks(int argc, char** argv, const std::vector<BenchCase>& cases);
@@ -0,0 +1,14 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - benchmark build (no raylib)
+ *
+ * Core cases only; the GUI build runs these plus the Draw*Screen
+ * cases with "--bench".
+ ********************************************************************/
+
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    std::vector<BenchCase> cases;
+    AddCoreBenchCases(cases);
+    return RunBenchmarks(argc, argv, cases);
+}
@@ -0,0 +1,746 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - calculation core
+ ********************************************************************/
+
+#include "circuitcore.h"
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <climits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+ComponentStore componentsData;
+MemberList seriesCircuit;
+MemberList parallelCircuit;
+
+BoundedRing<UndoEntry, MAX_UNDO_STEPS> undoJournal;
+BoundedRing<UndoEntry, MAX_UNDO_STEPS> redoStack;
+BoundedRing<Operation, MAX_UNDO_STEPS> opQueue;
+int nextId = 1;
+int circuitRevision = 0;
+CircuitSums seriesSums;
+CircuitSums parallelSums;
+int editsSinceResync = 0;
+int transactionDepth = 0;
+std::shared_ptr<EditBatch> openTransaction;   // what the open transaction did so far
+double analysisFrequencyHz = 50.0;
+
+// ---------------------- Calculations -------------------------
+
+std::string TypeToString(ComponentType t) {
+    if (t == ComponentType::RESISTOR) return "Resistor";
+    if (t == ComponentType::CAPACITOR) return "Capacitor";
+    return "Inductor";
+}
+
+// simple real R (used for resistance summaries)
+double CalcImpedanceR(double R) { return R; }
+
+double CalcImpedanceL(double L, double freqHz) {
+    double omega = 2.0 * M_PI * freqHz;
+    return omega * L;
+}
+
+double CalcImpedanceC(double C, double freqHz) {
+    double omega = 2.0 * M_PI * freqHz;
+    if (C == 0.0) return 1e10;
+    return 1.0 / (omega * C);
+}
+
+// complex impedance for each component: R, jωL, -j/(ωC) [web:4][web:5]
+cd GetComponentImpedanceComplex(const Component* c, double freqHz) {
+    if (!c) return cd(0.0, 0.0);
+    if (c->type == ComponentType::RESISTOR) {
+        return cd(c->value, 0.0);
+    }
+    double omega = 2.0 * M_PI * freqHz;
+    if (c->type == ComponentType::INDUCTOR) {
+        return J * omega * c->value;          // jωL
+    }
+    // capacitor
+    if (c->value == 0.0) return cd(1e10, 0.0); // open circuit
+    return -J / (omega * c->value);            // -j/(ωC)
+}
+
+// original real helper kept (not used for |Z| now)
+double GetComponentImpedance(const Component* c, double freqHz) {
+    if (!c) return 0.0;
+    if (c->type == ComponentType::RESISTOR) return CalcImpedanceR(c->value);
+    if (c->type == ComponentType::CAPACITOR) return CalcImpedanceC(c->value, freqHz);
+    return CalcImpedanceL(c->value, freqHz);
+}
+
+// ---------------------- Persistent Store -------------------------
+
+// a node this store may write: copied first if a snapshot still shares it
+// (or created empty), edited in place otherwise
+template <typename Node>
+static Node* OwnNode(std::shared_ptr<StoreNode>& p) {
+    if (!p) {
+        p = std::allocate_shared<Node>(PoolAllocator<Node>());
+    }
+    else if (p.use_count() != 1) {
+        p = std::allocate_shared<Node>(PoolAllocator<Node>(), *static_cast<const Node*>(p.get()));
+    }
+    else {
+        // the last snapshot may have been dropped on another thread: see its
+        // reads before writing over them
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return static_cast<Node*>(p.get());
+}
+
+static const StoreBranch* AsBranch(const StoreNode* n) { return static_cast<const StoreBranch*>(n); }
+static const StoreLeaf* AsLeaf(const StoreNode* n) { return static_cast<const StoreLeaf*>(n); }
+
+// index math is unsigned and 64-bit wide: a shift of 35 bits is defined
+static int SlotAt(int id, int level) {
+    return (int)(((uint64_t)(uint32_t)id >> (STORE_BITS * level)) & (STORE_WIDTH - 1));
+}
+
+// whether a trie with `levels` branch levels reaches id (id >= 0)
+static bool Covers(int levels, int id) {
+    return ((uint64_t)(uint32_t)id >> (STORE_BITS * (levels + 1))) == 0;
+}
+
+const Component* ComponentStore::Find(int id) const {
+    if (id < 0 || !root || !Covers(levels, id)) return nullptr;
+    const StoreNode* n = root.get();
+    for (int level = levels; level > 0; --level) {
+        n = AsBranch(n)->child[SlotAt(id, level)].get();
+        if (!n) return nullptr;
+    }
+    int slot = SlotAt(id, 0);
+    return (n->used >> slot) & 1u ? &AsLeaf(n)->item[slot] : nullptr;
+}
+
+// the leaf holding `id`, made writable along its path; path/index record
+// the branches above it for Erase
+static StoreLeaf* OwnPath(std::shared_ptr<StoreNode>& root, int levels, int id, StoreBranch** path, int* index) {
+    std::shared_ptr<StoreNode>* p = &root;
+    for (int level = levels; level > 0; --level) {
+        StoreBranch* b = OwnNode<StoreBranch>(*p);
+        int i = SlotAt(id, level);
+        if (path) { path[level] = b; index[level] = i; }
+        b->used |= 1u << i;
+        p = &b->child[i];
+    }
+    return OwnNode<StoreLeaf>(*p);
+}
+
+void ComponentStore::Put(const Component& c) {
+    if (c.id < 0) return;
+    if (!root) levels = 0;
+    // grow: the old root becomes child 0 of a new one (never past
+    // STORE_MAX_LEVELS, which covers any int)
+    while (!Covers(levels, c.id)) {
+        if (root) {
+            auto top = std::allocate_shared<StoreBranch>(PoolAllocator<StoreBranch>());
+            top->child[0] = root;
+            top->used = 1;
+            root = top;
+        }
+        levels++;
+    }
+    StoreLeaf* leaf = OwnPath(root, levels, c.id, nullptr, nullptr);
+    int slot = SlotAt(c.id, 0);
+    if (!((leaf->used >> slot) & 1u)) count++;
+    leaf->used |= 1u << slot;
+    leaf->item[slot] = c;
+}
+
+bool ComponentStore::Erase(int id) {
+    if (!Find(id)) return false;
+    // writable path, then unlink whatever became empty
+    StoreBranch* path[STORE_MAX_LEVELS + 1];
+    int index[STORE_MAX_LEVELS + 1];
+    StoreNode* n = OwnPath(root, levels, id, path, index);
+    n->used &= ~(1u << SlotAt(id, 0));
+    count--;
+    for (int level = 1; level <= levels && n->used == 0; ++level) {
+        path[level]->child[index[level]].reset();
+        path[level]->used &= ~(1u << index[level]);
+        n = path[level];
+    }
+    if (count == 0) Clear();
+    return true;
+}
+
+void ComponentStore::Clear() {
+    root.reset();
+    levels = 0;
+    count = 0;
+}
+
+// first occupied slot with id >= from in the subtree of n (covering ids
+// from `base` at `level`)
+static bool SeekLeaf(const StoreNode* n, int level, int64_t base, int64_t from, ComponentStore::Iterator& it) {
+    int64_t span = (int64_t)1 << (STORE_BITS * level);   // ids per slot at this level
+    int64_t first = from > base ? (from - base) / span : 0;
+    for (int i = (int)std::min<int64_t>(first, STORE_WIDTH); i < STORE_WIDTH; ++i) {
+        if (!((n->used >> i) & 1u)) continue;
+        if (level == 0) {
+            it.leaf = AsLeaf(n);
+            it.base = (int)base;
+            it.slot = i;
+            return true;
+        }
+        if (SeekLeaf(AsBranch(n)->child[i].get(), level - 1, base + i * span, from, it)) return true;
+    }
+    return false;
+}
+
+ComponentStore::Iterator ComponentStore::LowerBound(int from) const {
+    Iterator it;
+    it.store = this;
+    if (!root || !SeekLeaf(root.get(), levels, 0, std::max(0, from), it)) return Iterator();
+    return it;
+}
+
+ComponentStore::Iterator ComponentStore::begin() const {
+    return LowerBound(0);
+}
+
+ComponentStore::Iterator& ComponentStore::Iterator::operator++() {
+    // rest of this leaf from the mask, then one descent per leaf
+    uint32_t rest = slot + 1 < STORE_WIDTH ? leaf->used >> (slot + 1) << (slot + 1) : 0;
+    if (rest) {
+        int next = slot + 1;
+        while (!((rest >> next) & 1u)) ++next;
+        slot = next;
+        return *this;
+    }
+    // the last leaf of the id range has no successor
+    *this = base > INT_MAX - STORE_WIDTH ? Iterator() : store->LowerBound(base + STORE_WIDTH);
+    return *this;
+}
+
+const Component* FindComponent(int id) {
+    return componentsData.Find(id);
+}
+
+// ---------------------- Membership Lists -------------------------
+
+int MemberList::push_back(int id) {
+    return insert_before(id, -1);
+}
+
+int MemberList::insert_before(int id, int before) {
+    int n;
+    if (freeHead >= 0) {
+        n = freeHead;
+        freeHead = nodes[n].next;
+    }
+    else {
+        n = (int)nodes.size();
+        nodes.push_back(MemberNode());
+    }
+    int after = before >= 0 ? nodes[before].prev : tail;
+    nodes[n] = MemberNode{ id, after, before };
+    if (after >= 0) nodes[after].next = n;
+    else head = n;
+    if (before >= 0) nodes[before].prev = n;
+    else tail = n;
+    count++;
+    return n;
+}
+
+void MemberList::unlink(int n) {
+    if (nodes[n].prev >= 0) nodes[nodes[n].prev].next = nodes[n].next;
+    else head = nodes[n].next;
+    if (nodes[n].next >= 0) nodes[nodes[n].next].prev = nodes[n].prev;
+    else tail = nodes[n].prev;
+    nodes[n].next = freeHead;
+    freeHead = n;
+    count--;
+}
+
+// every node at once; the arena keeps its capacity for the next circuit
+void MemberList::clear() {
+    nodes.clear();
+    head = tail = freeHead = -1;
+    count = 0;
+}
+
+// ---------------------- Running Sums -------------------------
+
+void ApplyToSums(const Component& c, int sign) {
+    CircuitSums& s = (c.circuitType == CircuitType::SERIES) ? seriesSums : parallelSums;
+    int t = (int)c.type;
+    s.count[t] += sign;
+    if (c.value == 0.0) s.zeros[t] += sign;
+    if (s.count[t] == 0) {
+        // reset exactly so add/remove round-off never lingers on an empty type
+        s.sum[t] = 0.0;
+        s.inv[t] = 0.0;
+    }
+    else {
+        s.sum[t] += sign * c.value;
+        if (c.value != 0.0) s.inv[t] += sign / c.value;
+    }
+    editsSinceResync++;
+}
+
+// ---------------------- Edit Journal -------------------------
+
+// the rings drop their oldest entry when full; nothing here allocates
+void RecordOperation(const UndoEntry& e, const Operation& op) {
+    undoJournal.push_back(e);
+    redoStack.clear();
+    opQueue.push_back(op);
+}
+
+MemberList& MembersOf(const Component& c) {
+    return (c.circuitType == CircuitType::SERIES) ? seriesCircuit : parallelCircuit;
+}
+
+// list node of the next member of c's circuit after c.id, -1 = none: the
+// first later part of that circuit in the store
+int FindSuccessorNode(const Component& c) {
+    for (auto it = componentsData.LowerBound(c.id + 1); it != componentsData.end(); ++it) {
+        if (it->circuitType == c.circuitType) return it->member;
+    }
+    return -1;
+}
+
+// node a journaled part goes back in front of. Undo and redo restore the
+// exact state the successor was recorded in, so the hint holds and this is
+// O(1); an entry without one (loaded from a snapshot) searches the store.
+int SuccessorNode(const Component& c, int successor) {
+    const MemberList& members = MembersOf(c);
+    if (successor == -1 && (members.tail < 0 || members.nodes[members.tail].id < c.id)) return -1;
+    if (successor > 0) {
+        const Component* next = componentsData.Find(successor);
+        if (next && next->circuitType == c.circuitType) {
+            int prev = members.nodes[next->member].prev;
+            if (prev < 0 || members.nodes[prev].id < c.id) return next->member;
+        }
+    }
+    return FindSuccessorNode(c);
+}
+
+// puts a component back at its id; componentsData is ordered by id and the
+// membership lists stay sorted by id because ids only ever grow
+void AttachComponent(const Component& c, int successor) {
+    Component linked = c;
+    linked.member = MembersOf(c).insert_before(c.id, SuccessorNode(c, successor));
+    componentsData.Put(linked);
+    ApplyToSums(c, +1);
+    circuitRevision++;
+}
+
+// O(1) apart from the trie walk: the part's own handle finds its list node
+void DetachComponent(int id) {
+    Component c = *componentsData.Find(id);
+    MembersOf(c).unlink(c.member);
+    ApplyToSums(c, -1);
+    componentsData.Erase(id);
+    circuitRevision++;
+}
+
+// parts of a bulk edit, in id order. They go back newest first, each in
+// front of the next member of its circuit found in the store, so a part
+// never searches past the part put back before it.
+void AttachBatch(const std::vector<Component>& parts) {
+    for (size_t i = parts.size(); i-- > 0;) {
+        Component c = parts[i];
+        c.member = MembersOf(c).insert_before(c.id, FindSuccessorNode(c));
+        componentsData.Put(c);
+        ApplyToSums(c, +1);
+    }
+    circuitRevision++;
+}
+
+void DetachBatch(const std::vector<Component>& parts) {
+    for (const Component& part : parts) {
+        Component c = *componentsData.Find(part.id);
+        MembersOf(c).unlink(c.member);
+        ApplyToSums(c, -1);
+        componentsData.Erase(c.id);
+    }
+    circuitRevision++;
+}
+
+void RestoreComponent(const Component& c) {
+    Component linked = c;
+    linked.member = MembersOf(c).push_back(c.id);
+    componentsData.Put(linked);
+    ApplyToSums(c, +1);
+    if (c.id >= nextId) nextId = c.id + 1;
+    circuitRevision++;
+}
+
+void AppendComponent(ComponentType type, double value, CircuitType circuit, double tolerance) {
+    RestoreComponent(Component(nextId, type, value, circuit, tolerance));
+}
+
+void ClearCircuit() {
+    componentsData.Clear();
+    seriesCircuit.clear();
+    parallelCircuit.clear();
+    undoJournal.clear();
+    redoStack.clear();
+    opQueue.clear();
+    seriesSums = CircuitSums();
+    parallelSums = CircuitSums();
+    editsSinceResync = 0;
+    transactionDepth = 0;
+    openTransaction.reset();
+    nextId = 1;
+    circuitRevision++;
+}
+
+void AddComponent(ComponentType type, double value, CircuitType circuit, double tolerance) {
+    int id = nextId;
+    AppendComponent(type, value, circuit, tolerance);
+    if (transactionDepth > 0) {
+        openTransaction->added.push_back(*FindComponent(id));
+        return;
+    }
+
+    Operation op;
+    int len = snprintf(op.description, sizeof(op.description), "Added %s to %s circuit (ID=%d, value=%g",
+        TypeToString(type).c_str(), circuit == CircuitType::SERIES ? "SERIES" : "PARALLEL", id, value);
+    if (tolerance > 0.0 && len > 0 && len < (int)sizeof(op.description)) {
+        len += snprintf(op.description + len, sizeof(op.description) - len, " +-%g%%", tolerance * 100.0);
+    }
+    if (len > 0 && len < (int)sizeof(op.description)) {
+        snprintf(op.description + len, sizeof(op.description) - len, ")");
+    }
+    RecordOperation(UndoEntry{ true, *FindComponent(id), nullptr, -1 }, op);   // appended: last
+}
+
+bool RemoveComponent(int id) {
+    const Component* c = FindComponent(id);
+    if (!c) return false;
+    if (transactionDepth > 0) {
+        // a part added earlier in the transaction just drops out of it: its
+        // entry is marked dead (member -1, the copies taken on add are always
+        // linked) in O(log n) and CommitTransaction compacts the list once
+        std::vector<Component>& added = openTransaction->added;
+        auto it = std::lower_bound(added.begin(), added.end(), id,
+            [](const Component& a, int v) { return a.id < v; });
+        if (it != added.end() && it->id == id) it->member = -1;
+        else openTransaction->removed.push_back(*c);
+        DetachComponent(id);
+        return true;
+    }
+
+    Operation op;
+    snprintf(op.description, sizeof(op.description), "Removed component ID=%d", id);
+    int next = MembersOf(*c).nodes[c->member].next;
+    RecordOperation(UndoEntry{ false, *c, nullptr, next < 0 ? -1 : MembersOf(*c).nodes[next].id }, op);
+    DetachComponent(id);
+    return true;
+}
+
+int RemoveComponents(int firstId, int lastId, const std::function<bool(const Component&)>& match) {
+    // collect first: erasing would free leaves under the iterator
+    std::vector<int> ids;
+    for (auto it = componentsData.LowerBound(firstId); it != componentsData.end() && it->id <= lastId; ++it) {
+        if (!match || match(*it)) ids.push_back(it->id);
+    }
+    if (ids.size() <= 1) return ids.empty() ? 0 : (int)RemoveComponent(ids[0]);
+
+    char description[sizeof(Operation::description)];
+    snprintf(description, sizeof(description), "Removed %zu components (IDs %d-%d)", ids.size(), ids.front(), ids.back());
+    BeginTransaction();
+    for (int id : ids) RemoveComponent(id);
+    CommitTransaction(description);
+    return (int)ids.size();
+}
+
+int AddComponents(const ComponentSpec* specs, size_t count) {
+    int first = nextId;
+    if (count <= 1) {
+        if (count == 1) AddComponent(specs[0].type, specs[0].value, specs[0].circuit, specs[0].tolerance);
+        return first;
+    }
+
+    BeginTransaction();
+    openTransaction->added.reserve(openTransaction->added.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        AddComponent(specs[i].type, specs[i].value, specs[i].circuit, specs[i].tolerance);
+    }
+    char description[sizeof(Operation::description)];
+    snprintf(description, sizeof(description), "Added %zu components (IDs %d-%d)", count, first, nextId - 1);
+    CommitTransaction(description);
+    return first;
+}
+
+// undo/redo patch the lists with the journaled component instead of
+// restoring a full copy
+void Undo() {
+    if (undoJournal.empty() || transactionDepth > 0) return;
+    UndoEntry e = undoJournal.back();
+    undoJournal.pop_back();
+    if (e.batch) {
+        DetachBatch(e.batch->added);
+        AttachBatch(e.batch->removed);
+    }
+    else if (e.added) DetachComponent(e.comp.id);
+    else AttachComponent(e.comp, e.successor);
+    redoStack.push_back(e);
+}
+
+void Redo() {
+    if (redoStack.empty() || transactionDepth > 0) return;
+    UndoEntry e = redoStack.back();
+    redoStack.pop_back();
+    if (e.batch) {
+        DetachBatch(e.batch->removed);
+        AttachBatch(e.batch->added);
+    }
+    else if (e.added) AttachComponent(e.comp, e.successor);
+    else DetachComponent(e.comp.id);
+    undoJournal.push_back(e);
+}
+
+// ---------------------- Transactions -------------------------
+
+void BeginTransaction() {
+    if (transactionDepth++ == 0) openTransaction = std::make_shared<EditBatch>();
+}
+
+void CommitTransaction(const char* description) {
+    if (transactionDepth == 0 || --transactionDepth > 0) return;
+    std::shared_ptr<EditBatch> batch = std::move(openTransaction);
+    std::vector<Component>& added = batch->added;      // ascending: ids only grow
+    std::vector<Component>& removed = batch->removed;
+    added.erase(std::remove_if(added.begin(), added.end(), [](const Component& a) { return a.member < 0; }),
+        added.end());
+    size_t parts = added.size() + removed.size();
+    if (parts == 0) return;
+    std::sort(removed.begin(), removed.end(), [](const Component& a, const Component& b) { return a.id < b.id; });
+
+    Operation op;
+    if (description) snprintf(op.description, sizeof(op.description), "%s", description);
+    else snprintf(op.description, sizeof(op.description), "Edited %zu components (%zu added, %zu removed)",
+        parts, added.size(), removed.size());
+    const Component& c = added.empty() ? removed.front() : added.front();
+    if (parts == 1) RecordOperation(UndoEntry{ !added.empty(), c }, op);
+    else RecordOperation(UndoEntry{ !added.empty(), c, batch }, op);
+}
+
+double CalcSeries(const MemberList& ids) {
+    double sum = 0.0;
+    for (int id : ids) {
+        const Component* c = FindComponent(id);
+        if (c && c->type == ComponentType::RESISTOR) sum += c->value;
+    }
+    return sum;
+}
+
+double CalcParallel(const MemberList& ids) {
+    double inv = 0.0;
+    for (int id : ids) {
+        const Component* c = FindComponent(id);
+        if (c && c->type == ComponentType::RESISTOR && c->value != 0.0) {
+            inv += 1.0 / c->value;
+        }
+    }
+    if (inv == 0.0) return 0.0;
+    return 1.0 / inv;
+}
+
+// series/parallel impedance magnitudes using complex math [web:4][web:5]
+double CalcSeriesImpedance(const MemberList& ids, double freqHz) {
+    cd sum(0.0, 0.0);
+    for (int id : ids) {
+        const Component* c = FindComponent(id);
+        if (c) sum += GetComponentImpedanceComplex(c, freqHz);
+    }
+    return std::abs(sum);
+}
+
+double CalcParallelImpedance(const MemberList& ids, double freqHz) {
+    cd inv(0.0, 0.0);
+    for (int id : ids) {
+        const Component* c = FindComponent(id);
+        if (c) {
+            cd z = GetComponentImpedanceComplex(c, freqHz);
+            if (z != cd(0.0, 0.0)) inv += cd(1.0, 0.0) / z;
+        }
+    }
+    if (inv == cd(0.0, 0.0)) return 0.0;
+    cd ztot = cd(1.0, 0.0) / inv;
+    return std::abs(ztot);
+}
+
+// ---------------------- Column Storage -------------------------
+
+CircuitColumns seriesColumns;
+CircuitColumns parallelColumns;
+int columnsRevision = -1;
+
+void BuildColumns(const MemberList& ids, CircuitColumns& cols) {
+    for (int t = 0; t < 3; ++t) {
+        cols.values[t].clear();
+        cols.reciprocals[t].clear();
+        cols.zeroCount[t] = 0;
+    }
+    for (int id : ids) {
+        const Component* c = FindComponent(id);
+        if (!c) continue;
+        int t = (int)c->type;
+        cols.values[t].push_back(c->value);
+        cols.reciprocals[t].push_back(c->value != 0.0 ? 1.0 / c->value : 0.0);
+        if (c->value == 0.0) cols.zeroCount[t]++;
+    }
+}
+
+// columns are rebuilt lazily, at most once per circuit revision
+void EnsureColumns() {
+    if (columnsRevision == circuitRevision) return;
+    BuildColumns(seriesCircuit, seriesColumns);
+    BuildColumns(parallelCircuit, parallelColumns);
+    columnsRevision = circuitRevision;
+}
+
+// Four running sums in two 2-lane double registers (SSE2 on x86-64,
+// NEON on AArch64), else four scalar accumulators in the same lanes. The
+// lanes are added in a fixed order, so every path gives the same bits.
+double SumColumn(const std::vector<double>& v) {
+    const double* p = v.data();
+    size_t n = v.size();
+    double a0, a1, a2, a3;
+    size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    __m128d s01 = _mm_setzero_pd(), s23 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        s01 = _mm_add_pd(s01, _mm_loadu_pd(p + i));
+        s23 = _mm_add_pd(s23, _mm_loadu_pd(p + i + 2));
+    }
+    double lanes[4];
+    _mm_storeu_pd(lanes, s01);
+    _mm_storeu_pd(lanes + 2, s23);
+    a0 = lanes[0]; a1 = lanes[1]; a2 = lanes[2]; a3 = lanes[3];
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float64x2_t s01 = vdupq_n_f64(0.0), s23 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        s01 = vaddq_f64(s01, vld1q_f64(p + i));
+        s23 = vaddq_f64(s23, vld1q_f64(p + i + 2));
+    }
+    a0 = vgetq_lane_f64(s01, 0); a1 = vgetq_lane_f64(s01, 1);
+    a2 = vgetq_lane_f64(s23, 0); a3 = vgetq_lane_f64(s23, 1);
+#else
+    a0 = a1 = a2 = a3 = 0.0;
+    for (; i + 4 <= n; i += 4) {
+        a0 += p[i];
+        a1 += p[i + 1];
+        a2 += p[i + 2];
+        a3 += p[i + 3];
+    }
+#endif
+    for (; i < n; ++i) a0 += p[i];
+    return (a0 + a1) + (a2 + a3);
+}
+
+CircuitSums ReduceColumns(const CircuitColumns& cols) {
+    CircuitSums s;
+    for (int t = 0; t < 3; ++t) {
+        s.sum[t] = SumColumn(cols.values[t]);
+        s.inv[t] = SumColumn(cols.reciprocals[t]);
+        s.count[t] = (int)cols.values[t].size();
+        s.zeros[t] = cols.zeroCount[t];
+    }
+    return s;
+}
+
+// same results as the list versions above, built from the per-type totals:
+// R -> R, L -> jwL, C -> -j/(wC) (a zero C is an open circuit, 1e10)
+double CalcSeries(const CircuitSums& s) {
+    return s.sum[(int)ComponentType::RESISTOR];
+}
+
+double CalcParallel(const CircuitSums& s) {
+    double inv = s.inv[(int)ComponentType::RESISTOR];
+    if (inv == 0.0) return 0.0;
+    return 1.0 / inv;
+}
+
+cd CalcSeriesImpedanceComplex(const CircuitSums& s, double freqHz) {
+    double omega = 2.0 * M_PI * freqHz;
+    const int R = (int)ComponentType::RESISTOR, L = (int)ComponentType::INDUCTOR, C = (int)ComponentType::CAPACITOR;
+    double re = s.sum[R] + 1e10 * s.zeros[C];
+    double im = omega * s.sum[L];
+    if (s.count[C] > s.zeros[C]) im -= s.inv[C] / omega;
+    return cd(re, im);
+}
+
+cd CalcParallelImpedanceComplex(const CircuitSums& s, double freqHz) {
+    double omega = 2.0 * M_PI * freqHz;
+    const int R = (int)ComponentType::RESISTOR, L = (int)ComponentType::INDUCTOR, C = (int)ComponentType::CAPACITOR;
+    // admittances: 1/R, 1/(jwL) = -j/(wL), 1/(-j/(wC)) = jwC; zero impedances are skipped
+    double re = s.inv[R] + 1e-10 * s.zeros[C];
+    double im = omega * s.sum[C];
+    if (omega != 0.0) im -= s.inv[L] / omega;
+    cd inv(re, im);
+    if (inv == cd(0.0, 0.0)) return cd(0.0, 0.0);
+    return cd(1.0, 0.0) / inv;
+}
+
+double CalcSeriesImpedance(const CircuitSums& s, double freqHz) {
+    return std::abs(CalcSeriesImpedanceComplex(s, freqHz));
+}
+
+double CalcParallelImpedance(const CircuitSums& s, double freqHz) {
+    return std::abs(CalcParallelImpedanceComplex(s, freqHz));
+}
+
+// ---------------------- Analysis Cache -------------------------
+
+// re-derive the running sums from the columns after this many incremental
+// updates, so add/remove round-off cannot drift without bound
+const int SUM_RESYNC_EDITS = 4096;
+
+AnalysisResult analysisCache;
+
+CircuitSums SumComponents(const ComponentStore& components, CircuitType circuit) {
+    CircuitSums s;
+    for (const Component& c : components) {
+        if (c.circuitType != circuit) continue;
+        int t = (int)c.type;
+        s.count[t]++;
+        if (c.value == 0.0) s.zeros[t]++;
+        else { s.sum[t] += c.value; s.inv[t] += 1.0 / c.value; }
+    }
+    return s;
+}
+
+AnalysisResult AnalyzeSums(const CircuitSums& series, const CircuitSums& parallel, double freqHz) {
+    AnalysisResult a;
+    a.freqHz = freqHz;
+    a.seriesR = CalcSeries(series);
+    a.parallelR = CalcParallel(parallel);
+    cd zs = CalcSeriesImpedanceComplex(series, freqHz);
+    cd zp = CalcParallelImpedanceComplex(parallel, freqHz);
+    a.seriesZ = std::abs(zs);
+    a.parallelZ = std::abs(zp);
+    // phasors add, magnitudes do not
+    a.combinedZ = std::abs(zs + zp);
+    return a;
+}
+
+// screens call this every frame; unless the circuit revision or the
+// frequency changed it returns the cached figures without any arithmetic
+const AnalysisResult& GetAnalysis() {
+    if (analysisCache.revision == circuitRevision && analysisCache.freqHz == analysisFrequencyHz) {
+        return analysisCache;
+    }
+    if (editsSinceResync >= SUM_RESYNC_EDITS) {
+        EnsureColumns();
+        seriesSums = ReduceColumns(seriesColumns);
+        parallelSums = ReduceColumns(parallelColumns);
+        editsSinceResync = 0;
+    }
+    analysisCache = AnalyzeSums(seriesSums, parallelSums, analysisFrequencyHz);
+    analysisCache.revision = circuitRevision;
+    return analysisCache;
+}
@@ -0,0 +1,324 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - calculation core
+ * Component store, edit journal and series/parallel impedance math.
+ *
+ * No raylib in here: this is shared by the GUI and the headless CLI.
+ ********************************************************************/
+
+#pragma once
+
+#include "pool.h"
+#include <vector>
+#include <iterator>
+#include <memory>
+#include <cstdint>
+#include <queue>
+#include <deque>
+#include <stack>
+#include <string>
+#include <complex>
+#include <functional>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ---------------------- Data Structures ---------------------------
+
+enum class ComponentType { RESISTOR = 0, CAPACITOR = 1, INDUCTOR = 2 };
+enum class CircuitType { SERIES = 0, PARALLEL = 1 };
+
+struct Component {
+    int id;
+    ComponentType type;
+    double value;
+    CircuitType circuitType;
+    int member;          // its node in its circuit's MemberList, -1 = not linked
+    double tolerance;    // relative, 0.05 = +-5 %; only Monte Carlo looks at it
+
+    Component(int _id, ComponentType _t, double _v, CircuitType _ct, double _tol = 0.0)
+        : id(_id), type(_t), value(_v), circuitType(_ct), member(-1), tolerance(_tol) {
+    }
+    // empty slot of a fixed-size table
+    Component() : Component(0, ComponentType::RESISTOR, 0.0, CircuitType::SERIES) {}
+};
+
+// one line of the operation log, formatted in place (no heap string)
+struct Operation {
+    char description[96];
+};
+
+// what a bulk edit or a transaction did, each list in id order
+struct EditBatch {
+    std::vector<Component> added;
+    std::vector<Component> removed;
+};
+
+// one journal entry per edit: what happened plus the component payload,
+// enough to replay it in either direction
+struct UndoEntry {
+    bool added;          // true = component was added, false = removed
+    Component comp;
+    // several parts: all of them, added/comp unused; null for one part
+    std::shared_ptr<const EditBatch> batch = nullptr;
+    // one part: id of the next member of its circuit right after an add or
+    // right before a remove (-1 = it is the last, 0 = not known), so
+    // replaying the entry relinks the part in O(1)
+    int successor = 0;
+};
+
+// one part for AddComponents
+struct ComponentSpec {
+    ComponentType type;
+    double value;
+    CircuitType circuit;
+    double tolerance = 0.0;
+};
+
+const size_t MAX_UNDO_STEPS = 20;
+
+// the newest N entries in a fixed array: pushing onto a full ring drops the
+// oldest, and nothing is ever allocated
+template <typename T, size_t N>
+struct BoundedRing {
+    T slots[N];
+    size_t first = 0;
+    size_t count = 0;
+
+    // vacated slots are reset so they do not keep a batch alive
+    void push_back(const T& v) {
+        if (count == N) { first = (first + 1) % N; count--; }
+        slots[(first + count) % N] = v;
+        count++;
+    }
+    void pop_back() { count--; slots[(first + count) % N] = T(); }
+    void pop_front() { slots[first] = T(); first = (first + 1) % N; count--; }
+    T& back() { return slots[(first + count - 1) % N]; }
+    const T& operator[](size_t i) const { return slots[(first + i) % N]; }   // 0 = oldest
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { while (count) pop_back(); first = 0; }
+};
+
+// ---------------------- Membership Lists -------------------------
+
+// One circuit's member ids in id order: a doubly linked list whose nodes
+// live in one arena vector and link by index. Unlinked nodes go on a free
+// list and are reused, and clear() frees them all at once while keeping
+// the arena, so after warm-up an edit never touches the heap (a std::list
+// pays one allocation and 16 bytes of links per int id). Node indices are
+// stable, and each Component keeps its own in `member`, so a part is
+// unlinked in O(1) without searching the list.
+struct MemberNode {
+    int id;
+    int prev, next;   // arena indices, -1 = none
+};
+
+struct MemberList {
+    std::vector<MemberNode> nodes;
+    int head = -1, tail = -1;
+    int freeHead = -1;
+    size_t count = 0;
+
+    struct Iterator {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef const int& reference;
+
+        const MemberList* list;
+        int node;
+        const int& operator*() const { return list->nodes[node].id; }
+        Iterator& operator++() { node = list->nodes[node].next; return *this; }
+        bool operator==(const Iterator& o) const { return node == o.node; }
+        bool operator!=(const Iterator& o) const { return node != o.node; }
+    };
+
+    Iterator begin() const { return Iterator{ this, head }; }
+    Iterator end() const { return Iterator{ this, -1 }; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // each returns the new node's index
+    int push_back(int id);
+    int insert_before(int id, int before);   // before = -1: at the back
+    void unlink(int node);
+    void clear();
+    void reserve(size_t n) { nodes.reserve(n); }
+};
+
+// frequency-independent per-type totals of one circuit, kept up to date on
+// every edit; all R and |Z| figures are O(1) from these
+struct CircuitSums {
+    double sum[3] = { 0.0, 0.0, 0.0 };   // indexed by (int)ComponentType
+    double inv[3] = { 0.0, 0.0, 0.0 };   // sum of reciprocals, zero values skipped
+    int count[3] = { 0, 0, 0 };
+    int zeros[3] = { 0, 0, 0 };
+};
+
+// ---------------------- Persistent Store -------------------------
+
+// componentsData: a persistent (structurally shared) sparse vector indexed
+// by id, as a 32-way trie. ids are handed out sequentially from nextId, so
+// the trie stays dense and 1M parts are 4 levels deep. Copying a store is
+// one pointer copy (a snapshot); an edit copies only the nodes on its path
+// that a snapshot still shares and updates unshared nodes in place, so
+// edits without a live snapshot cost no allocations.
+const int STORE_BITS = 5;
+const int STORE_WIDTH = 1 << STORE_BITS;
+// branch levels that cover every non-negative int id (7 x 5 bits >= 31)
+const int STORE_MAX_LEVELS = 6;
+// the largest id a component may have, so nextId still fits an int
+const int MAX_COMPONENT_ID = 0x7FFFFFFE;
+
+// A node is a branch or a leaf by its level. Each is one block from the
+// pools (pool.h), control block included, so nodes freed by an edit or a
+// dropped snapshot are reused instead of going back to malloc.
+struct StoreNode {
+    uint32_t used = 0;   // occupied child/item slots
+};
+
+struct StoreBranch : StoreNode {
+    std::shared_ptr<StoreNode> child[STORE_WIDTH];
+};
+
+struct StoreLeaf : StoreNode {
+    Component item[STORE_WIDTH];
+};
+
+struct ComponentStore {
+    std::shared_ptr<StoreNode> root;
+    int levels = 0;      // branch levels above the leaves
+    size_t count = 0;
+
+    // id order; holds raw node pointers, so the store must outlive it
+    struct Iterator {
+        const ComponentStore* store = nullptr;
+        const StoreLeaf* leaf = nullptr;   // nullptr = end
+        int base = 0;                      // id of leaf->item[0]
+        int slot = 0;
+        const Component& operator*() const { return leaf->item[slot]; }
+        const Component* operator->() const { return &leaf->item[slot]; }
+        Iterator& operator++();
+        bool operator==(const Iterator& o) const { return leaf == o.leaf && slot == o.slot; }
+        bool operator!=(const Iterator& o) const { return !(*this == o); }
+    };
+
+    // valid until the next edit of this store
+    const Component* Find(int id) const;
+    void Put(const Component& c);   // insert or replace at c.id
+    bool Erase(int id);
+    void Clear();
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Iterator begin() const;
+    Iterator end() const { return Iterator(); }
+    // first occupied slot at or after id `from`
+    Iterator LowerBound(int from) const;
+};
+
+// Structure-of-arrays copy of one circuit: values grouped by ComponentType in
+// contiguous arrays (plus their reciprocals, 0 for a zero value), so a full
+// re-derivation of the totals is one branch-free add loop per type instead of
+// a list walk with a type switch per element.
+struct CircuitColumns {
+    std::vector<double> values[3];        // indexed by (int)ComponentType
+    std::vector<double> reciprocals[3];
+    int zeroCount[3] = { 0, 0, 0 };
+};
+
+struct AnalysisResult {
+    int revision = -1;
+    double freqHz = 0.0;
+    double seriesR = 0.0;
+    double parallelR = 0.0;
+    double seriesZ = 0.0;
+    double parallelZ = 0.0;
+    double combinedZ = 0.0;   // |Zseries + Zparallel|, the two blocks in series
+};
+
+extern ComponentStore componentsData;
+extern MemberList seriesCircuit;
+extern MemberList parallelCircuit;
+
+extern BoundedRing<UndoEntry, MAX_UNDO_STEPS> undoJournal;   // oldest entry at index 0
+extern BoundedRing<UndoEntry, MAX_UNDO_STEPS> redoStack;     // newest undone edit at the back
+extern BoundedRing<Operation, MAX_UNDO_STEPS> opQueue;
+extern int nextId;
+extern int circuitRevision;   // bumped on every add/remove/undo
+extern CircuitSums seriesSums;
+extern CircuitSums parallelSums;
+extern CircuitColumns seriesColumns;
+extern CircuitColumns parallelColumns;
+extern double analysisFrequencyHz;
+
+// complex type alias
+using cd = std::complex<double>;
+const cd J(0.0, 1.0);
+
+// ---------------------- Calculations -------------------------
+
+std::string TypeToString(ComponentType t);
+
+double CalcImpedanceR(double R);
+double CalcImpedanceL(double L, double freqHz);
+double CalcImpedanceC(double C, double freqHz);
+cd GetComponentImpedanceComplex(const Component* c, double freqHz);
+double GetComponentImpedance(const Component* c, double freqHz);
+
+// ---------------------- Component Store -------------------------
+
+const Component* FindComponent(int id);
+
+// adds without journaling or logging (loaders, batch runs)
+void AppendComponent(ComponentType type, double value, CircuitType circuit, double tolerance = 0.0);
+// same, keeping c's id (saved files); ids must come in ascending order
+void RestoreComponent(const Component& c);
+// empties the circuit, the journal and the log; ids restart at 1
+void ClearCircuit();
+
+void AddComponent(ComponentType type, double value, CircuitType circuit, double tolerance = 0.0);
+bool RemoveComponent(int id);
+// every part with an id in [firstId, lastId] that `match` accepts (all of
+// them when it is empty), as one journaled edit; returns how many went
+int RemoveComponents(int firstId, int lastId, const std::function<bool(const Component&)>& match = nullptr);
+// specs[0..count) as one journaled edit; returns the first new id
+int AddComponents(const ComponentSpec* specs, size_t count);
+// no-ops while a transaction is open
+void Undo();
+void Redo();
+
+// Every Add/Remove between BeginTransaction and CommitTransaction becomes
+// one journal entry and one log line (`description`, or a count of parts
+// when null). A part added and removed again inside it leaves no trace.
+// A nested Begin joins the open transaction; only the outermost Commit
+// records it.
+void BeginTransaction();
+void CommitTransaction(const char* description = nullptr);
+
+// ---------------------- Analysis -------------------------
+
+double CalcSeries(const MemberList& ids);
+double CalcParallel(const MemberList& ids);
+double CalcSeriesImpedance(const MemberList& ids, double freqHz);
+double CalcParallelImpedance(const MemberList& ids, double freqHz);
+
+void EnsureColumns();
+double SumColumn(const std::vector<double>& v);
+CircuitSums ReduceColumns(const CircuitColumns& cols);
+
+double CalcSeries(const CircuitSums& s);
+double CalcParallel(const CircuitSums& s);
+cd CalcSeriesImpedanceComplex(const CircuitSums& s, double freqHz);
+cd CalcParallelImpedanceComplex(const CircuitSums& s, double freqHz);
+double CalcSeriesImpedance(const CircuitSums& s, double freqHz);
+double CalcParallelImpedance(const CircuitSums& s, double freqHz);
+
+// the running sums of one circuit, rebuilt from a snapshot of the store
+CircuitSums SumComponents(const ComponentStore& components, CircuitType circuit);
+// R/|Z| of both circuits from their sums (revision left at -1)
+AnalysisResult AnalyzeSums(const CircuitSums& series, const CircuitSums& parallel, double freqHz);
+
+// cached R/|Z| of both circuits at analysisFrequencyHz
+const AnalysisResult& GetAnalysis();
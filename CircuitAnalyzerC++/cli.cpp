@@ -0,0 +1,9 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - command line build (no raylib)
+ ********************************************************************/
+
+#include "headless.h"
+
+int main(int argc, char** argv) {
+    return RunHeadless(argc, argv);
+}
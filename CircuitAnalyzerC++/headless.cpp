@@ -0,0 +1,436 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - headless batch mode
+ ********************************************************************/
+
+#include "headless.h"
+#include "circuitcore.h"
+#include "sweep.h"
+#include "mna.h"
+#include "parallel.h"
+#include "spice.h"
+#include "transient.h"
+#include "montecarlo.h"
+#include "sensitivity.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+void PrintNetworkReport(FILE* out, const Network& net) {
+    MnaSymbolic sym;
+    MnaWorkspace ws;
+    cd z;
+    if (!AnalyzeNetwork(net, sym) || !SolveInputImpedance(net, sym, ws, analysisFrequencyHz, z)) {
+        fprintf(out, "Network: %d nodes, %d elements | singular or no input node\n",
+            net.nodeCount, (int)net.elements.size());
+        return;
+    }
+    fprintf(out, "Network: %d nodes, %d elements | Zin(node %d) = %.3f Ohm, phase %.2f deg\n",
+        net.nodeCount, (int)net.elements.size(), net.inputNode, std::abs(z), std::arg(z) * (180.0 / M_PI));
+}
+
+// same lines and number formats as DrawCalcScreen
+// `listsFromNet`: the lists were loaded from net (a SPICE deck), so they
+// only stand for it when it is series + parallel
+void PrintAnalysisReport(FILE* out, const char* name, int index, const Network& net, bool listsFromNet) {
+    const AnalysisResult& a = GetAnalysis();
+
+    fprintf(out, "Circuit Analysis Report [%s #%d]\n", name, index);
+    fprintf(out, "Frequency: %.1f Hz\n", analysisFrequencyHz);
+    if (listsFromNet && !IsSeriesParallelNetwork(net)) {
+        fprintf(out, "Series / Parallel: n/a (general network, %d components)\n", (int)net.elements.size());
+        PrintNetworkReport(out, net);
+        fprintf(out, "\n");
+        return;
+    }
+    fprintf(out, "Series: %d components | R = %.3f Ohm | Z = %.3f Ohm\n",
+        (int)seriesCircuit.size(), a.seriesR, a.seriesZ);
+    fprintf(out, "Parallel: %d components | R = %.3f Ohm | Z = %.3f Ohm\n",
+        (int)parallelCircuit.size(), a.parallelR, a.parallelZ);
+
+    if (!seriesCircuit.empty() && !parallelCircuit.empty()) {
+        fprintf(out, "COMBINED (Series + Parallel):\n");
+        fprintf(out, "Total R = %.3f Ohm | Total Z = %.3f Ohm\n",
+            a.seriesR + a.parallelR, a.combinedZ);
+    }
+    else if (!seriesCircuit.empty()) {
+        fprintf(out, "Only Series Circuit (Resistance dominates)\n");
+    }
+    else if (!parallelCircuit.empty()) {
+        fprintf(out, "Only Parallel Circuit (Resistance dominates)\n");
+    }
+    else if (net.elements.empty()) {
+        fprintf(out, "No components added yet!\n");
+    }
+    if (!net.elements.empty()) PrintNetworkReport(out, net);
+    fprintf(out, "\n");
+}
+
+struct HeadlessOptions {
+    double freqHz = 50.0;
+    bool sweep = false;          // CSV sweep instead of the report
+    SweepSettings sweepSettings;
+    int threads = HardwareThreads();
+    bool transient = false;      // CSV step/pulse response instead of the report
+    TransientSettings transientSettings;
+    bool monteCarlo = false;     // tolerance histograms instead of the report
+    MonteCarloSettings monteCarloSettings;
+    bool sensitivity = false;    // ranked dZ/dvalue table instead of the report
+    bool spiceDeck = false;      // the lists were loaded from the network
+};
+
+void EmitTransient(FILE* out, const char* name, int index, const Network& net, const HeadlessOptions& opts) {
+    fprintf(out, "# %s #%d\n", name, index);
+    Network built;
+    if (net.elements.empty()) BuildNetworkFromCircuits(built);
+    TransientStats stats;
+    if (WriteTransientCsv(out, net.elements.empty() ? built : net, opts.transientSettings, stats)) {
+        fprintf(out, "# %lld steps, %lld rejected, %lld factorizations\n",
+            stats.steps, stats.rejected, stats.factorizations);
+    }
+    else {
+        fprintf(out, "# invalid source, empty or singular network\n");
+    }
+    fprintf(out, "\n");
+}
+
+void EmitMonteCarlo(FILE* out, const char* name, int index, const Network& net, const HeadlessOptions& opts) {
+    MonteCarloSettings mc = opts.monteCarloSettings;
+    mc.freqHz = analysisFrequencyHz;
+    mc.threads = opts.threads;
+    fprintf(out, "Monte Carlo [%s #%d]: %lld samples at %.1f Hz, yield band +-%.1f%%\n",
+        name, index, mc.samples, mc.freqHz, mc.yieldBand * 100.0);
+
+    MonteCarloResult r;
+    if (!componentsData.empty() && RunMonteCarlo(mc, r)) {
+        if (!seriesCircuit.empty()) PrintMonteCarloHistogram(out, "Series |Z|", r.series, r.samples);
+        if (!parallelCircuit.empty()) PrintMonteCarloHistogram(out, "Parallel |Z|", r.parallel, r.samples);
+        if (!seriesCircuit.empty() && !parallelCircuit.empty()) {
+            PrintMonteCarloHistogram(out, "Combined |Z|", r.combined, r.samples);
+        }
+    }
+    MonteCarloHistogram zin;
+    if (!net.elements.empty()) {
+        if (RunNetworkMonteCarlo(net, mc, zin)) PrintMonteCarloHistogram(out, "Network Zin", zin, mc.samples);
+        else fprintf(out, "Network: singular or no input node\n");
+    }
+    fprintf(out, "\n");
+}
+
+void EmitSensitivity(FILE* out, const char* name, int index, const Network& net) {
+    std::vector<SensitivityEntry> entries;
+    if (!componentsData.empty()) {
+        double z = CircuitSensitivities(analysisFrequencyHz, entries);
+        fprintf(out, "# %s #%d: series + parallel |Z| = %.6g Ohm at %.1f Hz\n", name, index, z, analysisFrequencyHz);
+        PrintSensitivityTable(out, entries, (int)entries.size());
+    }
+    if (!net.elements.empty()) {
+        cd zIn;
+        if (NetworkSensitivities(net, analysisFrequencyHz, entries, zIn)) {
+            fprintf(out, "# %s #%d: network |Zin| = %.6g Ohm at %.1f Hz\n", name, index, std::abs(zIn), analysisFrequencyHz);
+            PrintSensitivityTable(out, entries, (int)entries.size());
+        }
+        else {
+            fprintf(out, "# %s #%d: network singular or no input node\n", name, index);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void EmitCircuit(FILE* out, const char* name, int index, const Network& net, const HeadlessOptions& opts) {
+    if (opts.sensitivity) {
+        EmitSensitivity(out, name, index, net);
+        return;
+    }
+    if (opts.monteCarlo) {
+        EmitMonteCarlo(out, name, index, net, opts);
+        return;
+    }
+    if (opts.transient) {
+        EmitTransient(out, name, index, net, opts);
+        return;
+    }
+    if (!opts.sweep) {
+        PrintAnalysisReport(out, name, index, net, opts.spiceDeck);
+        return;
+    }
+    fprintf(out, "# %s #%d\n", name, index);
+    if (!net.elements.empty()) WriteNetworkSweepCsv(out, net, opts.sweepSettings, opts.threads);
+    else WriteSweepCsv(out, opts.sweepSettings);
+    fprintf(out, "\n");
+}
+
+// optional "<percent>%" after the value or S/P (0 when absent; other
+// trailing text is ignored as before); false on a percent out of range
+bool ParseTolerance(const char* p, double& tolerance) {
+    tolerance = 0.0;
+    while (*p && !isspace((unsigned char)*p)) ++p;   // rest of the S/P word
+    char* end;
+    double percent = strtod(p, &end);
+    if (end == p || *end != '%') return true;
+    if (percent < 0.0 || percent >= 100.0) return false;
+    tolerance = percent / 100.0;
+    return true;
+}
+
+// parses one netlist line into the current circuit; false on a bad line
+bool ParseNetlistLine(char* line, Network& net, bool& endOfCircuit) {
+    endOfCircuit = false;
+    char* p = line;
+    while (isspace((unsigned char)*p)) ++p;
+    if (*p == '\0' || *p == '*' || *p == '#') return true;
+
+    if (*p == '.') {
+        if (strncmp(p, ".end", 4) == 0) { endOfCircuit = true; return true; }
+        if (strncmp(p, ".port", 5) == 0) {
+            char* end;
+            long node = strtol(p + 5, &end, 10);
+            if (end == p + 5 || node <= 0) return false;
+            net.inputNode = (int)node;
+            return true;
+        }
+        if (strncmp(p, ".freq", 5) == 0) {
+            char* end;
+            double f = strtod(p + 5, &end);
+            if (end == p + 5 || f <= 0.0) return false;
+            analysisFrequencyHz = f;
+            return true;
+        }
+        return false;
+    }
+
+    ComponentType type;
+    switch (toupper((unsigned char)*p)) {
+    case 'R': type = ComponentType::RESISTOR; break;
+    case 'L': type = ComponentType::INDUCTOR; break;
+    case 'C': type = ComponentType::CAPACITOR; break;
+    default: return false;
+    }
+    ++p;
+
+    char* end;
+    if (!isspace((unsigned char)*p)) {
+        // node form "<R|L|C><name> <nodeA> <nodeB> <value>", node 0 = ground
+        while (*p && !isspace((unsigned char)*p)) ++p;
+        long a = strtol(p, &end, 10);
+        if (end == p || a < 0) return false;
+        p = end;
+        long b = strtol(p, &end, 10);
+        if (end == p || b < 0) return false;
+        p = end;
+        double value = strtod(p, &end);
+        if (end == p || value <= 0.0) return false;
+        double tolerance;
+        if (!ParseTolerance(end, tolerance)) return false;
+        AddNetElement(net, type, value, (int)a, (int)b);
+        net.elements.back().comp.tolerance = tolerance;
+        return true;
+    }
+
+    double value = strtod(p, &end);
+    if (end == p || value <= 0.0) return false;
+    p = end;
+    while (isspace((unsigned char)*p)) ++p;
+
+    CircuitType circuit;
+    switch (toupper((unsigned char)*p)) {
+    case 'S': circuit = CircuitType::SERIES; break;
+    case 'P': circuit = CircuitType::PARALLEL; break;
+    default: return false;
+    }
+    double tolerance;
+    if (!ParseTolerance(p, tolerance)) return false;
+
+    AppendComponent(type, value, circuit, tolerance);
+    return true;
+}
+
+// runs every circuit in one stream; returns the number of bad lines
+int RunNetlistStream(FILE* in, const char* name, const HeadlessOptions& opts, FILE* out) {
+    char line[512];
+    int lineNo = 0;
+    int errors = 0;
+    int index = 1;
+    Network net;
+
+    ClearCircuit();
+    analysisFrequencyHz = opts.freqHz;
+    while (fgets(line, sizeof(line), in)) {
+        ++lineNo;
+        bool endOfCircuit;
+        if (!ParseNetlistLine(line, net, endOfCircuit)) {
+            fprintf(stderr, "%s:%d: invalid netlist line: %s", name, lineNo, line);
+            errors++;
+            continue;
+        }
+        if (endOfCircuit) {
+            EmitCircuit(out, name, index++, net, opts);
+            ClearCircuit();
+            net = Network();
+            analysisFrequencyHz = opts.freqHz;
+        }
+    }
+    if (!componentsData.empty() || !net.elements.empty()) EmitCircuit(out, name, index, net, opts);
+    return errors;
+}
+
+// one SPICE deck, bulk-loaded; its .ac line picks the sweep unless --sweep did
+int RunSpiceFile(const char* path, const HeadlessOptions& opts, FILE* out) {
+    Network net;
+    SpiceImportInfo info;
+    if (!ImportSpiceFile(path, net, info)) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    if (info.errors > 0) {
+        fprintf(stderr, "%s:%d: %d invalid SPICE line(s), first here\n", path, info.firstErrorLine, info.errors);
+    }
+    LoadCircuitsFromNetwork(net);
+    analysisFrequencyHz = opts.freqHz;
+
+    HeadlessOptions deckOpts = opts;
+    deckOpts.spiceDeck = true;
+    if (info.hasAc && !opts.sweep) {
+        deckOpts.sweep = true;
+        deckOpts.sweepSettings = info.ac;
+    }
+    if (info.hasTran && !opts.transient && !opts.sweep) {
+        deckOpts.transient = true;
+        deckOpts.transientSettings = info.tran;
+    }
+    EmitCircuit(out, path, 1, net, deckOpts);
+    return info.errors;
+}
+
+int RunHeadless(int argc, char** argv) {
+    HeadlessOptions opts;
+    int files = 0;
+    int errors = 0;
+
+    // big output buffer: thousands of small reports per second otherwise
+    // spend their time in write() calls
+    static char outBuf[1 << 16];
+    setvbuf(stdout, outBuf, _IOFBF, sizeof(outBuf));
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) continue;
+        if (strcmp(argv[i], "--freq") == 0 && i + 1 < argc) {
+            opts.freqHz = atof(argv[++i]);
+            if (opts.freqHz <= 0.0) {
+                fprintf(stderr, "--freq needs a positive frequency in Hz\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--sweep") == 0 && i + 3 < argc) {
+            opts.sweep = true;
+            opts.sweepSettings.startHz = atof(argv[++i]);
+            opts.sweepSettings.stopHz = atof(argv[++i]);
+            opts.sweepSettings.points = atoi(argv[++i]);
+            if (!SweepSettingsValid(opts.sweepSettings)) {
+                fprintf(stderr, "--sweep needs <startHz> <stopHz> <points> with 0 < start < stop, points >= 2\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts.threads = atoi(argv[++i]);
+            if (opts.threads < 1) opts.threads = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--lin") == 0) {
+            opts.sweepSettings.scale = SweepScale::LINEAR;
+            continue;
+        }
+        if (strcmp(argv[i], "--tran") == 0 && i + 2 < argc) {
+            opts.transient = true;
+            opts.transientSettings.stopTime = atof(argv[++i]);
+            opts.transientSettings.maxStep = atof(argv[++i]);
+            if (!TransientSettingsValid(opts.transientSettings)) {
+                fprintf(stderr, "--tran needs <stop> <maxStep>, both positive times in seconds\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--pulse") == 0 && i + 7 < argc) {
+            TransientSource& src = opts.transientSettings.source;
+            src.v1 = atof(argv[++i]);
+            src.v2 = atof(argv[++i]);
+            src.delay = atof(argv[++i]);
+            src.rise = atof(argv[++i]);
+            src.fall = atof(argv[++i]);
+            src.width = atof(argv[++i]);
+            src.period = atof(argv[++i]);
+            if (!TransientSettingsValid(opts.transientSettings)) {
+                fprintf(stderr, "--pulse needs <v1> <v2> <delay> <rise> <fall> <width> <period>, times >= 0\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--rs") == 0 && i + 1 < argc) {
+            opts.transientSettings.source.seriesR = atof(argv[++i]);
+            if (opts.transientSettings.source.seriesR <= 0.0) {
+                fprintf(stderr, "--rs needs a positive source resistance in Ohm\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--sens") == 0) {
+            opts.sensitivity = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--mc") == 0 && i + 1 < argc) {
+            opts.monteCarlo = true;
+            opts.monteCarloSettings.samples = atoll(argv[++i]);
+            if (!MonteCarloSettingsValid(opts.monteCarloSettings)) {
+                fprintf(stderr, "--mc needs a sample count from 1 to %lld\n", MC_MAX_SAMPLES);
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opts.monteCarloSettings.seed = strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (strcmp(argv[i], "--gauss") == 0) {
+            opts.monteCarloSettings.distribution = ToleranceDistribution::GAUSSIAN;
+            continue;
+        }
+        if (strcmp(argv[i], "--yield") == 0 && i + 1 < argc) {
+            opts.monteCarloSettings.yieldBand = atof(argv[++i]) / 100.0;
+            if (opts.monteCarloSettings.yieldBand < 0.0) {
+                fprintf(stderr, "--yield needs a band in percent >= 0\n");
+                return 2;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--be") == 0) {
+            opts.transientSettings.method = TransientMethod::BACKWARD_EULER;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--spice") == 0 && i + 1 < argc) {
+            files++;
+            errors += RunSpiceFile(argv[++i], opts, stdout);
+            continue;
+        }
+
+        files++;
+        if (strcmp(argv[i], "-") == 0) {
+            errors += RunNetlistStream(stdin, "stdin", opts, stdout);
+            continue;
+        }
+        FILE* in = fopen(argv[i], "r");
+        if (!in) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            errors++;
+            continue;
+        }
+        errors += RunNetlistStream(in, argv[i], opts, stdout);
+        fclose(in);
+    }
+    if (files == 0) errors += RunNetlistStream(stdin, "stdin", opts, stdout);
+
+    fflush(stdout);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - headless batch mode
+ *
+ * Netlist format, one component per line:
+ *     <R|L|C> <value> <S|P> [tol%] e.g.  "R 100 S", "C 1e-6 P 10%"
+ *     <R|L|C><name> <a> <b> <value> [tol%]  general network element
+ *                                  between nodes a and b (0 = ground),
+ *                                  e.g. "R1 1 2 100 5%"; solved by nodal
+ *                                  analysis
+ *     .port <node>                 network input node (default 1)
+ *     .freq <Hz>                   analysis frequency (default 50 Hz)
+ *     .end                         ends a circuit; more may follow
+ * Blank lines and lines starting with '*' or '#' are ignored.
+ ********************************************************************/
+
+#pragma once
+
+// entry point for "--headless [--freq Hz] [--sweep start stop points [--lin]]
+// [--tran stop maxStep [--pulse v1 v2 delay rise fall width period] [--rs Ohm]
+// [--be]] [--mc samples [--seed S] [--gauss] [--yield pct]] [--sens]
+// [--threads N] [netlist ...] [--spice deck.cir ...]" (stdin when no files
+// are given);
+// prints the Total Circuit Analysis report per circuit, its Bode sweep as CSV
+// with --sweep (or a SPICE deck's .ac line), its step / pulse response as CSV
+// with --tran (or .tran; default a 0 -> 1 V step), or Monte Carlo tolerance
+// histograms and yield with --mc, or every component's d|Z|/dvalue ranked
+// by relative sensitivity with --sens
+int RunHeadless(int argc, char** argv);
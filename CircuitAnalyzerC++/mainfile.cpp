@@ -6,56 +6,27 @@
  ********************************************************************/
 
 #include "raylib.h"
-#include <list>
+#include "circuitcore.h"
+#include "headless.h"
+#include "sweep.h"
+#include "bench.h"
+#include "spice.h"
+#include "snapshot.h"
+#include "montecarlo.h"
+#include "sensitivity.h"
+#include "parallel.h"
+#include "analysisworker.h"
+#include "allocstats.h"
 #include <vector>
-#include <queue>
-#include <stack>
 #include <string>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
-#include <complex>   // for complex impedance [web:50]
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <algorithm>
+#include <memory>
 
 Font customFont;
 
-// ---------------------- Data Structures ---------------------------
-
-enum class ComponentType { RESISTOR = 0, CAPACITOR = 1, INDUCTOR = 2 };
-enum class CircuitType { SERIES = 0, PARALLEL = 1 };
-
-struct Component {
-    int id;
-    ComponentType type;
-    double value;
-    CircuitType circuitType;
-
-    Component(int _id, ComponentType _t, double _v, CircuitType _ct)
-        : id(_id), type(_t), value(_v), circuitType(_ct) {
-    }
-};
-
-struct Operation {
-    std::string description;
-};
-
-std::list<Component> componentsData;
-std::list<int> seriesCircuit;
-std::list<int> parallelCircuit;
-
-std::stack<std::list<Component> > undoStack;
-std::queue<Operation> opQueue;
-int nextId = 1;
-Component* searchedComponent = NULL;
-double analysisFrequencyHz = 50.0;
-
-// complex type alias
-using cd = std::complex<double>;
-const cd J(0.0, 1.0);
-
 // ---------------------- Utility -------------------------
 
 Color MakeColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
@@ -69,12 +40,6 @@ unsigned char ClampU8(int v) {
     return (unsigned char)v;
 }
 
-std::string TypeToString(ComponentType t) {
-    if (t == ComponentType::RESISTOR) return "Resistor";
-    if (t == ComponentType::CAPACITOR) return "Capacitor";
-    return "Inductor";
-}
-
 // component accent colors stay similar
 Color TypeColor(ComponentType t) {
     if (t == ComponentType::RESISTOR) return MakeColor(239, 83, 80, 255);      // soft red
@@ -86,145 +51,6 @@ void DrawTextEx_Custom(const std::string& text, float posX, float posY, int font
     DrawTextEx(customFont, text.c_str(), Vector2{ posX, posY }, (float)fontSize, 1.0f, color);
 }
 
-// ---------------------- Calculations -------------------------
-
-// simple real R (used for resistance summaries)
-double CalcImpedanceR(double R) { return R; }
-
-double CalcImpedanceL(double L, double freqHz) {
-    double omega = 2.0 * M_PI * freqHz;
-    return omega * L;
-}
-
-double CalcImpedanceC(double C, double freqHz) {
-    double omega = 2.0 * M_PI * freqHz;
-    if (C == 0.0) return 1e10;
-    return 1.0 / (omega * C);
-}
-
-// complex impedance for each component: R, jωL, -j/(ωC) [web:4][web:5]
-cd GetComponentImpedanceComplex(Component* c, double freqHz) {
-    if (!c) return cd(0.0, 0.0);
-    if (c->type == ComponentType::RESISTOR) {
-        return cd(c->value, 0.0);
-    }
-    double omega = 2.0 * M_PI * freqHz;
-    if (c->type == ComponentType::INDUCTOR) {
-        return J * omega * c->value;          // jωL
-    }
-    // capacitor
-    if (c->value == 0.0) return cd(1e10, 0.0); // open circuit
-    return -J / (omega * c->value);            // -j/(ωC)
-}
-
-// original real helper kept (not used for |Z| now)
-double GetComponentImpedance(Component* c, double freqHz) {
-    if (!c) return 0.0;
-    if (c->type == ComponentType::RESISTOR) return CalcImpedanceR(c->value);
-    if (c->type == ComponentType::CAPACITOR) return CalcImpedanceC(c->value, freqHz);
-    return CalcImpedanceL(c->value, freqHz);
-}
-
-void PushSnapshot(const std::string& desc) {
-    undoStack.push(componentsData);
-    Operation op{ desc };
-    opQueue.push(op);
-    if (opQueue.size() > 20) opQueue.pop();
-}
-
-void AddComponent(ComponentType type, double value, CircuitType circuit) {
-    componentsData.push_back(Component(nextId, type, value, circuit));
-    if (circuit == CircuitType::SERIES) seriesCircuit.push_back(nextId);
-    else parallelCircuit.push_back(nextId);
-
-    std::stringstream ss;
-    ss << "Added " << TypeToString(type) << " to "
-        << (circuit == CircuitType::SERIES ? "SERIES" : "PARALLEL")
-        << " circuit (ID=" << nextId << ", value=" << value << ")";
-    PushSnapshot(ss.str());
-    nextId++;
-}
-
-bool RemoveComponent(int id) {
-    for (auto it = componentsData.begin(); it != componentsData.end(); ++it) {
-        if (it->id == id) {
-            seriesCircuit.remove(id);
-            parallelCircuit.remove(id);
-            std::stringstream ss;
-            ss << "Removed component ID=" << id;
-            PushSnapshot(ss.str());
-            componentsData.erase(it);
-            return true;
-        }
-    }
-    return false;
-}
-
-Component* FindComponent(int id) {
-    for (auto it = componentsData.begin(); it != componentsData.end(); ++it) {
-        if (it->id == id) return &(*it);
-    }
-    return NULL;
-}
-
-void Undo() {
-    if (!undoStack.empty()) {
-        componentsData = undoStack.top();
-        undoStack.pop();
-        seriesCircuit.clear();
-        parallelCircuit.clear();
-        for (auto it = componentsData.begin(); it != componentsData.end(); ++it) {
-            if (it->circuitType == CircuitType::SERIES) seriesCircuit.push_back(it->id);
-            else parallelCircuit.push_back(it->id);
-        }
-    }
-}
-
-double CalcSeries(const std::list<int>& ids) {
-    double sum = 0.0;
-    for (int id : ids) {
-        Component* c = FindComponent(id);
-        if (c && c->type == ComponentType::RESISTOR) sum += c->value;
-    }
-    return sum;
-}
-
-double CalcParallel(const std::list<int>& ids) {
-    double inv = 0.0;
-    for (int id : ids) {
-        Component* c = FindComponent(id);
-        if (c && c->type == ComponentType::RESISTOR && c->value != 0.0) {
-            inv += 1.0 / c->value;
-        }
-    }
-    if (inv == 0.0) return 0.0;
-    return 1.0 / inv;
-}
-
-// series/parallel impedance magnitudes using complex math [web:4][web:5]
-double CalcSeriesImpedance(const std::list<int>& ids, double freqHz) {
-    cd sum(0.0, 0.0);
-    for (int id : ids) {
-        Component* c = FindComponent(id);
-        if (c) sum += GetComponentImpedanceComplex(c, freqHz);
-    }
-    return std::abs(sum);
-}
-
-double CalcParallelImpedance(const std::list<int>& ids, double freqHz) {
-    cd inv(0.0, 0.0);
-    for (int id : ids) {
-        Component* c = FindComponent(id);
-        if (c) {
-            cd z = GetComponentImpedanceComplex(c, freqHz);
-            if (z != cd(0.0, 0.0)) inv += cd(1.0, 0.0) / z;
-        }
-    }
-    if (inv == cd(0.0, 0.0)) return 0.0;
-    cd ztot = cd(1.0, 0.0) / inv;
-    return std::abs(ztot);
-}
-
 // ---------------------- Symbols -------------------------
 
 void DrawResistorSymbol(float x, float y, float size, Color color) {
@@ -286,17 +112,341 @@ void DrawComponentSymbol(ComponentType type, float x, float y, float size, Color
     else DrawInductorSymbol(x, y, size, color);
 }
 
+// ---------------------- Symbol Atlas -------------------------
+
+// Level of detail by on-screen symbol size (the `size` argument, pixels):
+// the full symbol, a plain IEC-style glyph, or a single colored tick.
+enum class SymbolLod { FULL, GLYPH, TICK };
+
+const float LOD_FULL_SIZE = 7.0f;
+const float LOD_GLYPH_SIZE = 3.5f;
+
+SymbolLod LodForSize(float size) {
+    if (size >= LOD_FULL_SIZE) return SymbolLod::FULL;
+    if (size >= LOD_GLYPH_SIZE) return SymbolLod::GLYPH;
+    return SymbolLod::TICK;
+}
+
+// The three symbols rendered once at startup, in white, into one texture:
+// full detail at two sizes, the simplified glyphs, a label background and a
+// solid block for wires and ticks. Diagrams draw tinted quads from it with
+// DrawTexturePro, so everything but the text is a single texture batch.
+struct AtlasCell {
+    Rectangle src;            // source rect, flipped (render textures are upside down)
+    float anchorX, anchorY;   // where the symbol's (x, y) lies inside the cell
+    float bakedSize;          // the `size` it was drawn at
+};
+
+struct SymbolAtlas {
+    bool ready = false;
+    RenderTexture2D target;
+    AtlasCell full[2][3];     // baked at 10 and 20 px, by ComponentType
+    AtlasCell glyph[3];       // baked at 8 px
+    AtlasCell label;          // rounded label background
+    Rectangle solid;          // white texels
+};
+
+SymbolAtlas symbolAtlas;
+
+const int ATLAS_WIDTH = 512;
+const int ATLAS_HEIGHT = 128;
+
+// horizontal extent of each symbol relative to its x, in units of size
+float SymbolRightEdge(ComponentType type) {
+    if (type == ComponentType::RESISTOR) return 3.5f;
+    if (type == ComponentType::CAPACITOR) return 1.5f;
+    return 4.0f;
+}
+
+// IEC style: open box for R, two plates for C, filled box for L
+void DrawSymbolGlyph(ComponentType type, float x, float y, float size, Color color) {
+    float right = x + SymbolRightEdge(type) * size;
+    if (type == ComponentType::CAPACITOR) {
+        DrawLineV(Vector2{ x - size, y }, Vector2{ x, y }, color);
+        DrawRectangleRec(Rectangle{ x - 1.0f, y - size, 2.0f, 2.0f * size }, color);
+        DrawRectangleRec(Rectangle{ x + size * 0.5f - 1.0f, y - size, 2.0f, 2.0f * size }, color);
+        DrawLineV(Vector2{ x + size * 0.5f, y }, Vector2{ right, y }, color);
+        return;
+    }
+    float h = size * 0.5f;
+    Rectangle body = { x, y - h, right - size - x, 2.0f * h };
+    DrawLineV(Vector2{ x - size, y }, Vector2{ x, y }, color);
+    DrawLineV(Vector2{ body.x + body.width, y }, Vector2{ right, y }, color);
+    if (type == ComponentType::INDUCTOR) DrawRectangleRec(body, color);
+    else DrawRectangleLinesEx(body, 1.0f, color);
+}
+
+// the full symbols, with the inductor's coils as rings so the cell stays
+// transparent inside them
+void DrawSymbolForAtlas(ComponentType type, float x, float y, float size, Color color) {
+    if (type != ComponentType::INDUCTOR) {
+        DrawComponentSymbol(type, x, y, size, color);
+        return;
+    }
+    float coilRadius = size * 0.4f;
+    float spacing = size * 0.6f;
+    DrawLine((int)(x - size), (int)y, (int)x, (int)y, color);
+    for (int i = 0; i < 4; ++i) {
+        DrawRing(Vector2{ x + i * spacing, y }, coilRadius - 2.0f, coilRadius, 0.0f, 360.0f, 24, color);
+    }
+    DrawLine((int)(x + size * 3.0f), (int)y, (int)(x + size * 4.0f), (int)y, color);
+}
+
+// a cell of w x h pixels at (cx, cy) in drawing coordinates
+AtlasCell MakeAtlasCell(float cx, float cy, float w, float h, float anchorX, float anchorY, float bakedSize) {
+    AtlasCell c;
+    c.src = Rectangle{ cx, (float)ATLAS_HEIGHT - cy - h, w, -h };
+    c.anchorX = anchorX;
+    c.anchorY = anchorY;
+    c.bakedSize = bakedSize;
+    return c;
+}
+
+void BakeSymbolAtlas() {
+    SymbolAtlas& a = symbolAtlas;
+    a.target = LoadRenderTexture(ATLAS_WIDTH, ATLAS_HEIGHT);
+    SetTextureFilter(a.target.texture, TEXTURE_FILTER_BILINEAR);
+    Color white = MakeColor(255, 255, 255, 255);
+
+    BeginTextureMode(a.target);
+    ClearBackground(MakeColor(0, 0, 0, 0));
+
+    // symbols span [x - size, x + 4 size] and [y - size, y + size]; cells get
+    // a 4 px margin so bilinear sampling never reaches a neighbour
+    const float bakedSizes[2] = { 10.0f, 20.0f };
+    float cy = 2.0f;
+    for (int s = 0; s < 2; ++s) {
+        float size = bakedSizes[s];
+        float w = 5.0f * size + 8.0f, h = 2.0f * size + 8.0f;
+        for (int t = 0; t < 3; ++t) {
+            float cx = 2.0f + t * (w + 4.0f);
+            DrawSymbolForAtlas((ComponentType)t, cx + 4.0f + size, cy + h / 2.0f, size, white);
+            a.full[s][t] = MakeAtlasCell(cx, cy, w, h, 4.0f + size, h / 2.0f, size);
+        }
+        cy += h + 4.0f;
+    }
+
+    const float glyphSize = 8.0f;
+    float gw = 5.0f * glyphSize + 8.0f, gh = 2.0f * glyphSize + 8.0f;
+    for (int t = 0; t < 3; ++t) {
+        float cx = 2.0f + t * (gw + 4.0f);
+        DrawSymbolGlyph((ComponentType)t, cx + 4.0f + glyphSize, cy + gh / 2.0f, glyphSize, white);
+        a.glyph[t] = MakeAtlasCell(cx, cy, gw, gh, 4.0f + glyphSize, gh / 2.0f, glyphSize);
+    }
+
+    // label background: rounded box, stretched to each label
+    DrawRectangleRounded(Rectangle{ 380.0f, 4.0f, 48.0f, 16.0f }, 0.5f, 6, white);
+    a.label = MakeAtlasCell(379.0f, 3.0f, 50.0f, 18.0f, 0.0f, 0.0f, 1.0f);
+
+    DrawRectangle(440, 4, 8, 8, white);
+    a.solid = MakeAtlasCell(442.0f, 6.0f, 4.0f, 4.0f, 0.0f, 0.0f, 1.0f).src;
+
+    EndTextureMode();
+    a.ready = true;
+}
+
+void UnloadSymbolAtlas() {
+    if (!symbolAtlas.ready) return;
+    UnloadRenderTexture(symbolAtlas.target);
+    symbolAtlas.ready = false;
+}
+
+void DrawAtlasCell(const AtlasCell& c, float x, float y, float size, Color tint) {
+    float k = size / c.bakedSize;
+    Rectangle dst = { x - c.anchorX * k, y - c.anchorY * k, c.src.width * k, -c.src.height * k };
+    DrawTexturePro(symbolAtlas.target.texture, c.src, dst, Vector2{ 0.0f, 0.0f }, 0.0f, tint);
+}
+
+void DrawAtlasRect(float x, float y, float w, float h, Color tint) {
+    DrawTexturePro(symbolAtlas.target.texture, symbolAtlas.solid, Rectangle{ x, y, w, h },
+        Vector2{ 0.0f, 0.0f }, 0.0f, tint);
+}
+
+// wires are axis-aligned, so a 1 px quad replaces the line
+void DrawAtlasLine(float x1, float y1, float x2, float y2, Color tint) {
+    float x = std::min(x1, x2), y = std::min(y1, y2);
+    DrawAtlasRect(x, y, std::max(1.0f, std::fabs(x2 - x1)), std::max(1.0f, std::fabs(y2 - y1)), tint);
+}
+
+// background for a label `width` pixels wide at font size fs
+void DrawAtlasLabelBack(float x, float y, float width, float fs) {
+    const AtlasCell& c = symbolAtlas.label;
+    Rectangle dst = { x - 0.3f * fs, y - 0.1f * fs, width + 0.6f * fs, 1.2f * fs };
+    DrawTexturePro(symbolAtlas.target.texture, c.src, dst, Vector2{ 0.0f, 0.0f }, 0.0f, MakeColor(255, 255, 255, 170));
+}
+
+void DrawAtlasSymbol(ComponentType type, float x, float y, float size) {
+    Color tint = TypeColor(type);
+    switch (LodForSize(size)) {
+    case SymbolLod::FULL:
+        DrawAtlasCell(symbolAtlas.full[size > 10.0f ? 1 : 0][(int)type], x, y, size, tint);
+        break;
+    case SymbolLod::GLYPH:
+        DrawAtlasCell(symbolAtlas.glyph[(int)type], x, y, size, tint);
+        break;
+    case SymbolLod::TICK: {
+        float right = x + SymbolRightEdge(type) * size;
+        DrawAtlasRect(x - size, y - 1.0f, std::max(1.0f, right - (x - size)), 2.0f, tint);
+        break;
+    }
+    }
+}
+
+// ---------------------- Label Cache -------------------------
+
+// A label laid out once: glyph indices into customFont and their x offsets
+// at the font's base size, so drawing it skips formatting, UTF-8 decoding
+// and the glyph lookup DrawTextEx does per character.
+const int LABEL_MAX_GLYPHS = 24;
+
+struct GlyphRun {
+    int count = 0;
+    float width = 0.0f;               // at base size, without spacing
+    int index[LABEL_MAX_GLYPHS];
+    float x[LABEL_MAX_GLYPHS];
+};
+
+// "ID:%d" and "%.2f" of one component. Direct-mapped by id and checked
+// against id and value, so an entry survives edits elsewhere and is only
+// redone when its slot is reused or the component behind the id changed.
+struct LabelEntry {
+    int id = -1;
+    double value = 0.0;
+    GlyphRun idRun, valueRun;
+};
+
+const int LABEL_CACHE_SLOTS = 4096;   // power of two, far above the labels on screen
+std::vector<LabelEntry> labelCache(LABEL_CACHE_SLOTS);
+
+void LayoutGlyphRun(const char* text, GlyphRun& run) {
+    run.count = 0;
+    float x = 0.0f;
+    for (const char* p = text; *p && run.count < LABEL_MAX_GLYPHS; ++p) {
+        int g = GetGlyphIndex(customFont, (unsigned char)*p);
+        run.index[run.count] = g;
+        run.x[run.count] = x;
+        run.count++;
+        int advance = customFont.glyphs[g].advanceX;
+        x += advance != 0 ? (float)advance : customFont.recs[g].width;
+    }
+    run.width = x;
+}
+
+const LabelEntry& GetComponentLabels(int id, double value) {
+    LabelEntry& e = labelCache[id & (LABEL_CACHE_SLOTS - 1)];
+    if (e.id != id || e.value != value) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "ID:%d", id);
+        LayoutGlyphRun(buf, e.idRun);
+        snprintf(buf, sizeof(buf), "%.2f", value);
+        LayoutGlyphRun(buf, e.valueRun);
+        e.id = id;
+        e.value = value;
+    }
+    return e;
+}
+
+float GlyphRunWidth(const GlyphRun& run, float fontSize, float spacing) {
+    if (run.count == 0) return 0.0f;
+    return run.width * fontSize / customFont.baseSize + (run.count - 1) * spacing;
+}
+
+// same placement as raylib's DrawTextCodepoint
+void DrawGlyphRun(const GlyphRun& run, Vector2 pos, float fontSize, float spacing, Color tint) {
+    float scale = fontSize / customFont.baseSize;
+    float pad = (float)customFont.glyphPadding;
+    for (int k = 0; k < run.count; ++k) {
+        int g = run.index[k];
+        const Rectangle& r = customFont.recs[g];
+        Rectangle src = { r.x - pad, r.y - pad, r.width + 2.0f * pad, r.height + 2.0f * pad };
+        Rectangle dst = { pos.x + run.x[k] * scale + k * spacing + (customFont.glyphs[g].offsetX - pad) * scale,
+            pos.y + (customFont.glyphs[g].offsetY - pad) * scale, src.width * scale, src.height * scale };
+        DrawTexturePro(customFont.texture, src, dst, Vector2{ 0.0f, 0.0f }, 0.0f, tint);
+    }
+}
+
+// a formatted line kept until the values it shows change
+struct CachedText {
+    double key[3] = { -1.0, -1.0, -1.0 };
+    std::string text;
+
+    bool Stale(double a, double b, double c) {
+        if (key[0] == a && key[1] == b && key[2] == c) return false;
+        key[0] = a; key[1] = b; key[2] = c;
+        return true;
+    }
+};
+
+CachedText seriesHintLine, parallelHintLine;
+CachedText seriesResultLine, parallelResultLine;
+
 // ---------------------- Diagrams -------------------------
 
-void DrawSeriesCircuitDiagram(float startX, float startY, float maxWidth) {
+// Flat copy of one circuit's members for drawing, rebuilt only when the
+// circuit changes. Item i's row/column follow from its index, so a frame
+// visits only the items that intersect the visible rectangle and the cost
+// does not grow with the circuit.
+struct DiagramItems {
+    int revision = -1;
+    std::vector<int> ids;
+    std::vector<ComponentType> types;
+    std::vector<double> values;
+};
+
+// scroll offset (screen pixels) and zoom of one diagram panel
+struct DiagramView {
+    float scroll = 0.0f;
+    float zoom = 1.0f;
+};
+
+DiagramItems seriesItems, parallelItems;
+DiagramView seriesView, parallelView;
+
+const float DIAGRAM_MIN_ZOOM = 0.02f;
+const float DIAGRAM_MAX_ZOOM = 2.0f;
+
+void RefreshDiagramItems(DiagramItems& items, const MemberList& members) {
+    if (items.revision == circuitRevision) return;
+    items.revision = circuitRevision;
+    items.ids.clear();
+    items.types.clear();
+    items.values.clear();
+    for (int id : members) {
+        const Component* c = FindComponent(id);
+        if (!c) continue;
+        items.ids.push_back(id);
+        items.types.push_back(c->type);
+        items.values.push_back(c->value);
+    }
+}
+
+// mouse wheel scrolls, Ctrl + wheel zooms, while the pointer is over `view`
+void HandleDiagramInput(DiagramView& v, Rectangle view) {
+    float wheel = GetMouseWheelMove();
+    if (wheel == 0.0f || !CheckCollisionPointRec(GetMousePosition(), view)) return;
+    if (IsKeyDown(KEY_LEFT_CONTROL)) {
+        float z = std::clamp(v.zoom * (wheel > 0.0f ? 1.25f : 0.8f), DIAGRAM_MIN_ZOOM, DIAGRAM_MAX_ZOOM);
+        v.scroll *= z / v.zoom;
+        v.zoom = z;
+    }
+    else {
+        v.scroll -= wheel * 40.0f;
+    }
+}
+
+// contentHeight is in unzoomed diagram units
+void ClampDiagramScroll(DiagramView& v, Rectangle view, float contentHeight) {
+    float maxScroll = std::max(0.0f, contentHeight * v.zoom - view.height);
+    v.scroll = std::clamp(v.scroll, 0.0f, maxScroll);
+}
+
+void DrawSeriesCircuitDiagram(float startX, float startY, float maxWidth, float maxHeight) {
     if (seriesCircuit.empty()) return;
 
     // how much to shift the CIRCUIT (not the title)
     const float offsetX = 350.0f;   // right
     const float offsetY = 20.0f;    // down
 
-    float currentX = startX + offsetX;
-    float currentY = startY + offsetY;
     float lineHeight = 70.0f;
     float compSpacing = 80.0f;
 
@@ -305,116 +455,142 @@ void DrawSeriesCircuitDiagram(float startX, float startY, float maxWidth) {
         Vector2{ startX, startY - 30.0f },
         18.0f, 0.7f, MakeColor(0, 150, 136, 255));
 
-    for (auto it = seriesCircuit.begin(); it != seriesCircuit.end(); ++it) {
-        Component* c = FindComponent(*it);
-        if (!c) continue;
-
-        // wrap, keeping same shifted origin
-        if (currentX + compSpacing > startX + maxWidth) {
-            currentX = startX + offsetX;
-            currentY += lineHeight;
+    RefreshDiagramItems(seriesItems, seriesCircuit);
+    int n = (int)seriesItems.ids.size();
+    if (n == 0) return;
+
+    // diagram coordinates are relative to the view corner, scaled by zoom;
+    // at zoom 1 and no scroll the first part sits where it always did
+    Rectangle view = { startX + offsetX - 45.0f, startY - 8.0f, maxWidth - offsetX + 45.0f, maxHeight };
+    const float padX = 45.0f, padY = 8.0f + offsetY;
+    HandleDiagramInput(seriesView, view);
+    float z = seriesView.zoom;
+    int perRow = std::max(1, (int)((view.width / z - padX) / compSpacing));
+    int rows = (n + perRow - 1) / perRow;
+    ClampDiagramScroll(seriesView, view, padY + (rows - 1) * lineHeight + 30.0f);
+    float s = seriesView.scroll;
+
+    if (seriesHintLine.Stale(n, rows, z)) {
+        seriesHintLine.text = TextFormat("%d parts, %d rows | zoom %.0f%% | wheel: scroll, Ctrl+wheel: zoom",
+            n, rows, z * 100.0f);
+    }
+    DrawTextEx(customFont, seriesHintLine.text.c_str(), Vector2{ startX, startY - 8.0f }, 11.0f, 1.0f, MakeColor(96, 125, 139, 255));
+
+    // rows whose parts (symbol, labels +-30) reach into the view
+    int firstRow = std::max(0, (int)std::floor((s / z - padY - 30.0f) / lineHeight));
+    int lastRow = std::min(rows - 1, (int)std::ceil(((s + view.height) / z - padY + 30.0f) / lineHeight));
+
+    // atlas quads first (one texture batch), then the text on top of them
+    Color wire = MakeColor(160, 174, 192, 255);
+    bool labels = LodForSize(10.0f * z) == SymbolLod::FULL;
+    BeginScissorMode((int)view.x, (int)view.y, (int)view.width, (int)view.height);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        int end = std::min(n, (row + 1) * perRow);
+        float currentY = view.y + (padY + row * lineHeight) * z - s;
+        for (int i = row * perRow; i < end; ++i) {
+            float currentX = view.x + (padX + (i - row * perRow) * compSpacing) * z;
+            if (labels) {
+                const LabelEntry& l = GetComponentLabels(seriesItems.ids[i], seriesItems.values[i]);
+                DrawAtlasLabelBack(currentX - 10.0f * z, currentY - 18.0f * z, GlyphRunWidth(l.idRun, 11.0f * z, 1.0f), 11.0f * z);
+                DrawAtlasLabelBack(currentX - 10.0f * z, currentY + 18.0f * z, GlyphRunWidth(l.valueRun, 10.0f * z, 1.0f), 10.0f * z);
+            }
+            DrawAtlasSymbol(seriesItems.types[i], currentX, currentY, 10.0f * z);
+            if (i > 0) DrawAtlasLine(currentX - 40.0f * z, currentY, currentX - 15.0f * z, currentY, wire);
+            if (i + 1 < n) DrawAtlasLine(currentX + 35.0f * z, currentY, currentX + 55.0f * z, currentY, wire);
         }
+    }
 
-        // shifted component
-        DrawComponentSymbol(c->type, currentX, currentY, 10.0f, TypeColor(c->type));
-
-        // labels move with component
-        DrawTextEx(customFont, TextFormat("ID:%d", c->id),
-            Vector2{ currentX - 10.0f, currentY - 18.0f },
-            11.0f, 1.0f, MakeColor(45, 55, 72, 255));
-        DrawTextEx(customFont, TextFormat("%.2f", c->value),
-            Vector2{ currentX - 10.0f, currentY + 18.0f },
-            10.0f, 1.0f, MakeColor(100, 110, 130, 255));
-
-        // shifted wires
-        if (it != seriesCircuit.begin()) {
-            DrawLine((int)(currentX - 40.0f), (int)currentY,
-                (int)(currentX - 15.0f), (int)currentY,
-                MakeColor(160, 174, 192, 255));
+    // labels move with component; unreadable below full detail
+    for (int row = firstRow; labels && row <= lastRow; ++row) {
+        int end = std::min(n, (row + 1) * perRow);
+        float currentY = view.y + (padY + row * lineHeight) * z - s;
+        for (int i = row * perRow; i < end; ++i) {
+            float currentX = view.x + (padX + (i - row * perRow) * compSpacing) * z;
+            const LabelEntry& l = GetComponentLabels(seriesItems.ids[i], seriesItems.values[i]);
+            DrawGlyphRun(l.idRun, Vector2{ currentX - 10.0f * z, currentY - 18.0f * z },
+                11.0f * z, 1.0f, MakeColor(45, 55, 72, 255));
+            DrawGlyphRun(l.valueRun, Vector2{ currentX - 10.0f * z, currentY + 18.0f * z },
+                10.0f * z, 1.0f, MakeColor(100, 110, 130, 255));
         }
-        if (std::next(it) != seriesCircuit.end()) {
-            DrawLine((int)(currentX + 35.0f), (int)currentY,
-                (int)(currentX + 55.0f), (int)currentY,
-                MakeColor(160, 174, 192, 255));
-        }
-
-        currentX += compSpacing;
     }
+    EndScissorMode();
 }
 
-
-void DrawParallelCircuitDiagram(float startX, float startY, float maxWidth) {
+void DrawParallelCircuitDiagram(float startX, float startY, float maxWidth, float maxHeight) {
     if (parallelCircuit.empty()) return;
 
     // how much to shift the circuit (not the title)
     const float offsetX = 350.0f;   // right
-    const float offsetY = 20.0f;    // down
 
-    float topRailY = startY - 20.0f + offsetY;
     float branchSpacing = 60.0f;
-    float bottomRailY = startY + (float)parallelCircuit.size() * branchSpacing + 20.0f + offsetY;
 
     // title stays at original position
     DrawTextEx(customFont, "PARALLEL CIRCUIT",
         Vector2{ startX, startY - 40.0f },
         18.0f, 1.0f, MakeColor(255, 152, 0, 255));
 
-    // shifted left and right rails
-    DrawLine((int)(startX + offsetX), (int)topRailY,
-        (int)(startX + offsetX + 80.0f), (int)topRailY, MakeColor(160, 174, 192, 255));
-    DrawLine((int)(startX + offsetX), (int)bottomRailY,
-        (int)(startX + offsetX + 80.0f), (int)bottomRailY, MakeColor(160, 174, 192, 255));
-    DrawLine((int)(startX + offsetX + 80.0f), (int)topRailY,
-        (int)(startX + offsetX + 80.0f), (int)bottomRailY, MakeColor(160, 174, 192, 255));
-
-    float branchY = topRailY + branchSpacing;
-    for (auto it = parallelCircuit.begin(); it != parallelCircuit.end(); ++it) {
-        Component* c = FindComponent(*it);
-        if (!c) continue;
-
-        // horizontal wire from left rail to component
-        DrawLine((int)(startX + offsetX + 80.0f), (int)branchY,
-            (int)(startX + offsetX + 110.0f), (int)branchY,
-            MakeColor(160, 174, 192, 255));
-
-        // component (shifted)
-        float compX = startX + offsetX + 140.0f;
-        DrawComponentSymbol(c->type, compX, branchY, 10.0f, TypeColor(c->type));
-
-        // horizontal wire from component to right vertical
-        DrawLine((int)(startX + offsetX + 170.0f), (int)branchY,
-            (int)(startX + offsetX + 220.0f), (int)branchY,
-            MakeColor(160, 174, 192, 255));
-
-        // vertical down to bottom rail
-        DrawLine((int)(startX + offsetX + 220.0f), (int)branchY,
-            (int)(startX + offsetX + 220.0f), (int)bottomRailY,
-            MakeColor(160, 174, 192, 255));
-
-        // labels (shift with circuit)
-        DrawTextEx(customFont, TextFormat("ID:%d", c->id),
-            Vector2{ startX + offsetX + 235.0f, branchY - 8.0f },
-            11.0f, 1.0f, MakeColor(45, 55, 72, 255));
-        DrawTextEx(customFont, TextFormat("%.2f", c->value),
-            Vector2{ startX + offsetX + 235.0f, branchY + 6.0f },
-            10.0f, 1.0f, MakeColor(100, 110, 130, 255));
-
-        branchY += branchSpacing;
+    RefreshDiagramItems(parallelItems, parallelCircuit);
+    int n = (int)parallelItems.ids.size();
+    if (n == 0) return;
+
+    // same scheme as the series diagram, branches stacked downwards
+    Rectangle view = { startX + offsetX - 10.0f, startY - 10.0f, maxWidth - offsetX + 10.0f, maxHeight };
+    const float padY = 10.0f;
+    HandleDiagramInput(parallelView, view);
+    float z = parallelView.zoom;
+    ClampDiagramScroll(parallelView, view, padY + n * branchSpacing + 45.0f);
+    float s = parallelView.scroll;
+
+    if (parallelHintLine.Stale(n, z, 0.0)) {
+        parallelHintLine.text = TextFormat("%d branches | zoom %.0f%% | wheel: scroll, Ctrl+wheel: zoom",
+            n, z * 100.0f);
+    }
+    DrawTextEx(customFont, parallelHintLine.text.c_str(), Vector2{ startX, startY - 14.0f }, 11.0f, 1.0f, MakeColor(96, 125, 139, 255));
+
+    Color wire = MakeColor(160, 174, 192, 255);
+    float X = view.x + 10.0f * z;
+    float topRailY = view.y + padY * z - s;
+    float bottomRailY = view.y + (padY + n * branchSpacing + 40.0f) * z - s;
+    bool labels = LodForSize(10.0f * z) == SymbolLod::FULL;
+
+    BeginScissorMode((int)view.x, (int)view.y, (int)view.width, (int)view.height);
+
+    // shifted rails; the right vertical covers every branch's drop to the
+    // bottom rail
+    DrawAtlasLine(X, topRailY, X + 80.0f * z, topRailY, wire);
+    DrawAtlasLine(X, bottomRailY, X + 80.0f * z, bottomRailY, wire);
+    DrawAtlasLine(X + 80.0f * z, topRailY, X + 80.0f * z, bottomRailY, wire);
+    DrawAtlasLine(X + 220.0f * z, topRailY, X + 220.0f * z, bottomRailY, wire);
+    DrawAtlasLine(X + 220.0f * z, topRailY, X + 280.0f * z, topRailY, wire);
+    DrawAtlasLine(X + 220.0f * z, bottomRailY, X + 280.0f * z, bottomRailY, wire);
+
+    // branches whose symbol and labels reach into the view: atlas quads
+    // first (one texture batch), then the text
+    int first = std::max(0, (int)std::floor((s / z - padY - 30.0f) / branchSpacing) - 1);
+    int last = std::min(n - 1, (int)std::ceil(((s + view.height) / z - padY + 30.0f) / branchSpacing));
+    for (int i = first; i <= last; ++i) {
+        float branchY = view.y + (padY + (i + 1) * branchSpacing) * z - s;
+        if (labels) {
+            const LabelEntry& l = GetComponentLabels(parallelItems.ids[i], parallelItems.values[i]);
+            DrawAtlasLabelBack(X + 235.0f * z, branchY - 8.0f * z, GlyphRunWidth(l.idRun, 11.0f * z, 1.0f), 11.0f * z);
+            DrawAtlasLabelBack(X + 235.0f * z, branchY + 6.0f * z, GlyphRunWidth(l.valueRun, 10.0f * z, 1.0f), 10.0f * z);
+        }
+        DrawAtlasLine(X + 80.0f * z, branchY, X + 110.0f * z, branchY, wire);
+        DrawAtlasSymbol(parallelItems.types[i], X + 140.0f * z, branchY, 10.0f * z);
+        DrawAtlasLine(X + 170.0f * z, branchY, X + 220.0f * z, branchY, wire);
+    }
+    for (int i = first; labels && i <= last; ++i) {
+        float branchY = view.y + (padY + (i + 1) * branchSpacing) * z - s;
+        const LabelEntry& l = GetComponentLabels(parallelItems.ids[i], parallelItems.values[i]);
+        DrawGlyphRun(l.idRun, Vector2{ X + 235.0f * z, branchY - 8.0f * z },
+            11.0f * z, 1.0f, MakeColor(45, 55, 72, 255));
+        DrawGlyphRun(l.valueRun, Vector2{ X + 235.0f * z, branchY + 6.0f * z },
+            10.0f * z, 1.0f, MakeColor(100, 110, 130, 255));
     }
 
-    // right vertical and exit wires (shifted)
-    DrawLine((int)(startX + offsetX + 220.0f), (int)topRailY,
-        (int)(startX + offsetX + 220.0f), (int)bottomRailY,
-        MakeColor(160, 174, 192, 255));
-    DrawLine((int)(startX + offsetX + 220.0f), (int)topRailY,
-        (int)(startX + offsetX + 280.0f), (int)topRailY,
-        MakeColor(160, 174, 192, 255));
-    DrawLine((int)(startX + offsetX + 220.0f), (int)bottomRailY,
-        (int)(startX + offsetX + 280.0f), (int)bottomRailY,
-        MakeColor(160, 174, 192, 255));
+    EndScissorMode();
 }
 
-
 // ---------------------- GUI State -------------------------
 
 enum class ScreenState {
@@ -423,15 +599,28 @@ enum class ScreenState {
     REMOVE_COMPONENT,
     SEARCH_COMPONENT,
     DISPLAY_ALL,
-    CALC_RESISTANCE
+    CALC_RESISTANCE,
+    BODE_PLOT
 };
 
 ScreenState currentScreen = ScreenState::MAIN_MENU;
 std::string textBuffer = "";
 ComponentType addType = ComponentType::RESISTOR;
 CircuitType addCircuit = CircuitType::SERIES;
+double addTolerance = 0.0;     // relative, picked on the Add screen
 std::string statusMessage = "";
+const char* SNAPSHOT_FILE = "circuit.snap";   // Save/Open on the main menu
 std::vector<int> selectedIds;
+int searchedId = -1;
+bool showFrameStats = false;   // F3 toggles the frame-time overlay
+double frameStartTime = 0.0;
+double frameWorkMs = 0.0;      // smoothed CPU time spent building a frame
+long long frameStartAllocs = 0; // AllocationCount() when the frame began
+
+// CONTINUOUS redraws every frame at the target FPS; ON_DEMAND only when
+// something changed (see RunFrame)
+enum class RenderMode { CONTINUOUS, ON_DEMAND };
+RenderMode renderMode = RenderMode::ON_DEMAND;   // F4 or --render continuous|on-demand
 
 // ---------------------- Helpers -------------------------
 
@@ -444,6 +633,38 @@ void HandleTextInput(std::string& buf, int maxLen) {
     if (IsKeyPressed(KEY_BACKSPACE) && !buf.empty()) buf.pop_back();
 }
 
+// the last imported deck when it is not series + parallel; the report
+// solves it instead of the lists until the circuit is next edited
+std::shared_ptr<const Network> importedNetwork;
+int importedRevision = -1;
+
+// a snapshot or SPICE deck dropped on the window replaces the circuit (any screen)
+void HandleDroppedFiles() {
+    if (!IsFileDropped()) return;
+    FilePathList files = LoadDroppedFiles();
+    if (files.count > 0) {
+        const char* path = files.paths[0];
+        Network net;
+        SpiceImportInfo info;
+        if (IsFileExtension(path, ".snap")) {
+            statusMessage = TextFormat("Open: %s", SnapshotStatusText(OpenSnapshot(path)));
+        }
+        else if (!ImportSpiceFile(path, net, info)) {
+            statusMessage = "Cannot open the dropped file.";
+        }
+        else {
+            LoadCircuitsFromNetwork(net);
+            bool general = !IsSeriesParallelNetwork(net);
+            importedNetwork = general ? std::make_shared<const Network>(std::move(net)) : nullptr;
+            importedRevision = circuitRevision;
+            statusMessage = TextFormat("Imported %d components (%d lines skipped, %d invalid)%s.",
+                info.elements, info.skipped, info.errors, general ? ", general network" : "");
+        }
+        currentScreen = ScreenState::ADD_COMPONENT;
+    }
+    UnloadDroppedFiles(files);
+}
+
 double StringToDoubleSafe(const std::string& s, bool& ok) {
     ok = false;
     if (s.empty()) return 0.0;
@@ -458,17 +679,35 @@ int StringToIntSafe(const std::string& s, bool& ok) {
     catch (...) { return 0; }
 }
 
+// one vertex-colored quad; the GPU interpolates the same top-to-bottom
+// blend the old per-row DrawLine loop computed on the CPU
 void DrawGradientBackground(int w, int h) {
-    for (int y = 0; y < h; ++y) {
-        float t = (float)y / (float)h;
-        Color c = MakeColor(
-            (unsigned char)(245 - 20 * t),
-            (unsigned char)(250 - 30 * t),
-            (unsigned char)(255 - 40 * t),
-            255
-        );
-        DrawLine(0, y, w, y, c);
-    }
+    DrawRectangleGradientV(0, 0, w, h,
+        MakeColor(245, 250, 255, 255),
+        MakeColor(225, 220, 215, 255));
+}
+
+void DrawFrameStats(int w) {
+    if (IsKeyPressed(KEY_F3)) showFrameStats = !showFrameStats;
+    double workMs = (GetTime() - frameStartTime) * 1000.0;
+    frameWorkMs = frameWorkMs * 0.9 + workMs * 0.1;
+    long long allocs = AllocationCount();
+    if (!showFrameStats) return;
+
+    Rectangle box = { (float)w - 250.0f, 80.0f, 230.0f, 62.0f };
+    DrawRectangleRec(box, MakeColor(33, 33, 33, 200));
+    DrawTextEx(customFont,
+        TextFormat("draw %.2f ms | frame %.1f ms | %d FPS", frameWorkMs, GetFrameTime() * 1000.0f, GetFPS()),
+        Vector2{ box.x + 8, box.y + 6 }, 13.0f, 1.0f, MakeColor(245, 245, 245, 255));
+    DrawTextEx(customFont,
+        renderMode == RenderMode::ON_DEMAND ? "render: on demand (F4)" : "render: continuous (F4)",
+        Vector2{ box.x + 8, box.y + 24 }, 13.0f, 1.0f, MakeColor(200, 200, 200, 255));
+    // heap allocations of all threads: this frame so far, since start-up,
+    // and the 64 KB chunks behind the component pools
+    DrawTextEx(customFont,
+        TextFormat("allocs %lld/frame | %lld total | %lld pool chunks",
+            allocs - frameStartAllocs, allocs, PoolChunkCount()),
+        Vector2{ box.x + 8, box.y + 42 }, 13.0f, 1.0f, MakeColor(200, 200, 200, 255));
 }
 
 void DrawGlassPanel(Rectangle r, Color tint) {
@@ -513,14 +752,13 @@ void DrawBackButton() {
         textBuffer.clear();
         statusMessage.clear();
         selectedIds.clear();
-        searchedComponent = NULL;
+        searchedId = -1;
     }
 }
 
 // ---------------------- Screens -------------------------
 
 void DrawMainMenu(int w, int h) {
-    BeginDrawing();
     DrawGradientBackground(w, h);
 
     Rectangle header = { 0, 0, (float)w, 100 };
@@ -539,31 +777,39 @@ void DrawMainMenu(int w, int h) {
     float bh = 48.0f;
     float gap = 12.0f;
 
-    Rectangle btns[6];
-    for (int i = 0; i < 6; ++i) {
+    Rectangle btns[10];
+    for (int i = 0; i < 10; ++i) {
         btns[i] = { bx, by + i * (bh + gap), bw, bh };
     }
 
-    const char* labels[6] = {
+    const char* labels[10] = {
         "Add Component (Series/Parallel)",
         "Remove Component",
         "Search Component",
         "Display Circuit Diagrams",
         "Total Circuit Analysis",
-        "Undo Last Operation"
+        "Frequency Sweep (Bode Plot)",
+        "Undo Last Operation",
+        "Redo Last Operation",
+        "Save Circuit (circuit.snap)",
+        "Open Circuit (circuit.snap)"
     };
 
-    Color btnColors[6] = {
+    Color btnColors[10] = {
         MakeColor(0, 150, 136, 220),
         MakeColor(244, 81, 30, 220),
         MakeColor(255, 167, 38, 220),
         MakeColor(102, 187, 106, 220),
         MakeColor(124, 77, 255, 220),
-        MakeColor(3, 155, 229, 220)
+        MakeColor(94, 53, 177, 220),
+        MakeColor(3, 155, 229, 220),
+        MakeColor(2, 119, 189, 220),
+        MakeColor(84, 110, 122, 220),
+        MakeColor(69, 90, 100, 220)
     };
 
     Vector2 m = GetMousePosition();
-    for (int i = 0; i < 6; ++i) {
+    for (int i = 0; i < 10; ++i) {
         bool hover = CheckCollisionPointRec(m, btns[i]);
         DrawButtonEx(btns[i], labels[i], hover, btnColors[i]);
         if (hover && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
@@ -576,7 +822,11 @@ void DrawMainMenu(int w, int h) {
             case 2: currentScreen = ScreenState::SEARCH_COMPONENT; break;
             case 3: currentScreen = ScreenState::DISPLAY_ALL; break;
             case 4: currentScreen = ScreenState::CALC_RESISTANCE; break;
-            case 5: Undo(); break;
+            case 5: currentScreen = ScreenState::BODE_PLOT; break;
+            case 6: Undo(); break;
+            case 7: Redo(); break;
+            case 8: statusMessage = TextFormat("Save: %s", SnapshotStatusText(SaveSnapshot(SNAPSHOT_FILE))); break;
+            case 9: statusMessage = TextFormat("Open: %s", SnapshotStatusText(OpenSnapshot(SNAPSHOT_FILE))); break;
             }
         }
     }
@@ -589,12 +839,11 @@ void DrawMainMenu(int w, int h) {
             (int)parallelCircuit.size(),
             nextId),
         Vector2{ 40, (float)infoY }, 14.0f, 1.0f, MakeColor(55, 71, 79, 255));
+    DrawTextEx(customFont, statusMessage.c_str(), Vector2{ 600, (float)infoY }, 14.0f, 1.0f, MakeColor(55, 71, 79, 255));
 
-    EndDrawing();
 }
 
 void DrawAddScreen(int w, int h) {
-    BeginDrawing();
     DrawGradientBackground(w, h);
     DrawCommonTopBar(w, "Add Component to Circuit");
     DrawBackButton();
@@ -653,6 +902,17 @@ void DrawAddScreen(int w, int h) {
         16.0f, 1.0f, MakeColor(55, 71, 79, 255));
     HandleTextInput(textBuffer, 16);
 
+    DrawTextEx(customFont, "Tolerance:", Vector2{ 370, 355 }, 16.0f, 1.0f, MakeColor(38, 70, 83, 255));
+    const double tolerances[5] = { 0.0, 0.01, 0.05, 0.10, 0.20 };
+    const char* tolLabels[5] = { "exact", "1%", "5%", "10%", "20%" };
+    for (int i = 0; i < 5; ++i) {
+        Rectangle tBtn = { 370.0f + i * 62.0f, 380.0f, 56.0f, 38.0f };
+        bool hT = CheckCollisionPointRec(m, tBtn);
+        Color tColor = (addTolerance == tolerances[i]) ? MakeColor(126, 87, 194, 240) : MakeColor(126, 87, 194, 150);
+        DrawButtonEx(tBtn, tolLabels[i], hT, tColor);
+        if (hT && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) addTolerance = tolerances[i];
+    }
+
     Rectangle addBtn = { 70.0f, 430.0f, 130.0f, 40.0f };
     bool hAdd = CheckCollisionPointRec(m, addBtn);
     DrawButtonEx(addBtn, "Add", hAdd, MakeColor(102, 187, 106, 220));
@@ -661,7 +921,7 @@ void DrawAddScreen(int w, int h) {
         bool ok;
         double v = StringToDoubleSafe(textBuffer, ok);
         if (ok && v > 0.0) {
-            AddComponent(addType, v, addCircuit);
+            AddComponent(addType, v, addCircuit, addTolerance);
             statusMessage = "Component added successfully!";
             textBuffer.clear();
         }
@@ -671,12 +931,12 @@ void DrawAddScreen(int w, int h) {
     }
 
     DrawTextEx(customFont, statusMessage.c_str(), Vector2{ 70, 485 }, 14.0f, 1.0f, MakeColor(211, 47, 47, 255));
+    DrawTextEx(customFont, "Or drop a SPICE netlist (.cir / .sp) on the window to import it.",
+        Vector2{ 70, 515 }, 14.0f, 1.0f, MakeColor(96, 125, 139, 255));
 
-    EndDrawing();
 }
 
 void DrawRemoveScreen(int w, int h) {
-    BeginDrawing();
     DrawGradientBackground(w, h);
     DrawCommonTopBar(w, "Remove Component");
     DrawBackButton();
@@ -684,7 +944,7 @@ void DrawRemoveScreen(int w, int h) {
     Rectangle panel = { 40.0f, 120.0f, 500.0f, 250.0f };
     DrawGlassPanel(panel, MakeColor(244, 81, 30, 255));
 
-    DrawTextEx(customFont, "Enter Component ID to remove:", Vector2{ 70, 150 }, 16.0f, 1.0f, MakeColor(38, 70, 83, 255));
+    DrawTextEx(customFont, "Enter Component ID or a range (e.g. 10-500) to remove:", Vector2{ 70, 150 }, 16.0f, 1.0f, MakeColor(38, 70, 83, 255));
     Rectangle inputBox = { 70.0f, 180.0f, 270.0f, 38.0f };
     DrawRectangleRounded(inputBox, 0.2f, 8, MakeColor(255, 255, 255, 220));
     DrawRectangleRoundedLines(inputBox, 0.2f, 8, MakeColor(255, 205, 210, 255));
@@ -698,9 +958,20 @@ void DrawRemoveScreen(int w, int h) {
     DrawButtonEx(remBtn, "Remove", hRem, MakeColor(229, 57, 53, 220));
 
     if (hRem && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-        bool ok;
-        int id = StringToIntSafe(textBuffer, ok);
-        if (ok) {
+        bool ok, ok2;
+        size_t dash = textBuffer.find('-', 1);
+        int id = StringToIntSafe(textBuffer.substr(0, dash), ok);
+        if (dash != std::string::npos) {
+            // a range goes as one edit, undone in one step
+            int last = StringToIntSafe(textBuffer.substr(dash + 1), ok2);
+            if (ok && ok2 && id <= last) {
+                statusMessage = TextFormat("%d component(s) removed.", RemoveComponents(id, last));
+            }
+            else {
+                statusMessage = "Invalid range.";
+            }
+        }
+        else if (ok) {
             statusMessage = RemoveComponent(id) ? "Component removed!" : "Not found.";
         }
         else {
@@ -711,11 +982,9 @@ void DrawRemoveScreen(int w, int h) {
 
     DrawTextEx(customFont, statusMessage.c_str(), Vector2{ 70, 285 }, 14.0f, 1.0f, MakeColor(198, 40, 40, 255));
 
-    EndDrawing();
 }
 
 void DrawSearchScreen(int w, int h) {
-    BeginDrawing();
     DrawGradientBackground(w, h);
     DrawCommonTopBar(w, "Search Component");
     DrawBackButton();
@@ -739,13 +1008,14 @@ void DrawSearchScreen(int w, int h) {
     if (hSearch && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
         bool ok;
         int id = StringToIntSafe(textBuffer, ok);
-        searchedComponent = ok ? FindComponent(id) : NULL;
-        statusMessage = searchedComponent ? "Found!" : "Not found.";
+        searchedId = ok ? id : -1;
+        statusMessage = FindComponent(searchedId) ? "Found!" : "Not found.";
         textBuffer.clear();
     }
 
     DrawTextEx(customFont, statusMessage.c_str(), Vector2{ 70, 285 }, 14.0f, 1.0f, MakeColor(230, 81, 0, 255));
 
+    const Component* searchedComponent = FindComponent(searchedId);
     if (searchedComponent) {
         int y = 340;
         DrawTextEx(customFont, TextFormat("ID: %d", searchedComponent->id),
@@ -764,11 +1034,63 @@ void DrawSearchScreen(int w, int h) {
             12.0f, TypeColor(searchedComponent->type));
     }
 
-    EndDrawing();
+}
+
+// ---------------------- Background Analysis -------------------------
+
+// The Calc and Display screens show the newest report of the analysis
+// worker; nothing heavier than a copy of the circuit runs on this thread.
+const long long REPORT_MC_SAMPLES = 100000;
+std::shared_ptr<const AnalysisReport> calcReport;   // newest finished report
+std::shared_ptr<AnalysisSnapshot> unsentSnapshot;   // waiting for room in the job queue
+int postedRevision = -1;
+double postedFreqHz = 0.0;
+const AnalysisResult noAnalysis;
+
+// once per frame, before drawing: when `wanted` and the circuit or the
+// frequency changed, posts a snapshot, then picks up finished reports.
+// True while the screen should keep redrawing (a job is outstanding or a
+// report just arrived).
+bool UpdateCalcAnalysis(bool wanted) {
+    if (wanted && (postedRevision != circuitRevision || postedFreqHz != analysisFrequencyHz)) {
+        unsentSnapshot = SnapshotCircuit(REPORT_MC_SAMPLES);
+        if (importedRevision == circuitRevision) unsentSnapshot->network = importedNetwork;
+        else importedNetwork.reset();
+        postedRevision = circuitRevision;
+        postedFreqHz = analysisFrequencyHz;
+    }
+    if (unsentSnapshot && !AnalysisWorkerRunning()) {
+        // no worker thread: run it here
+        auto report = std::make_shared<AnalysisReport>();
+        RunAnalysisJob(*unsentSnapshot, *report, [] { return true; });
+        calcReport = report;
+        unsentSnapshot.reset();
+        return true;
+    }
+    if (unsentSnapshot && PostAnalysis(unsentSnapshot)) unsentSnapshot.reset();
+    // busy first: a report pushed after this check is still outstanding
+    bool busy = unsentSnapshot != nullptr || AnalysisBusy();
+    bool arrived = PollAnalysis(calcReport);
+    return busy || arrived;
+}
+
+bool CalcAnalysisBusy() {
+    return unsentSnapshot != nullptr || AnalysisBusy();
+}
+
+// "analyzing 42%" bar, right-aligned at (right, y); drawn live, not cached
+void DrawAnalysisProgress(float right, float y) {
+    if (!CalcAnalysisBusy()) return;
+    double p = AnalysisProgress();
+    const char* text = TextFormat("analyzing %d%%", (int)(p * 100.0));
+    Vector2 size = MeasureTextEx(customFont, text, 13.0f, 1.0f);
+    Rectangle bar = { right - 120.0f, y + 3.0f, 120.0f, 10.0f };
+    DrawTextEx(customFont, text, Vector2{ bar.x - size.x - 10.0f, y }, 13.0f, 1.0f, MakeColor(255, 241, 118, 255));
+    DrawRectangleRec(bar, MakeColor(66, 66, 66, 255));
+    DrawRectangleRec(Rectangle{ bar.x, bar.y, (float)(bar.width * p), bar.height }, MakeColor(255, 241, 118, 255));
 }
 
 void DrawDisplayScreen(int w, int h) {
-    BeginDrawing();
     DrawGradientBackground(w, h);
     DrawCommonTopBar(w, "Circuit Diagrams");
     DrawBackButton();
@@ -776,20 +1098,28 @@ void DrawDisplayScreen(int w, int h) {
     Rectangle seriesPanel = { 40.0f, 120.0f, (float)w - 80.0f, 200.0f };
     DrawGlassPanel(seriesPanel, MakeColor(0, 188, 212, 255));
 
+    // R/|Z| of the newest report; the diagrams are the live circuit
+    const AnalysisResult& a = calcReport ? calcReport->analysis : noAnalysis;
+    // an imported general network: the per-list figures do not apply
+    bool general = calcReport && calcReport->hasNetwork;
+    const char* generalLine = "n/a: imported general network, see Total Circuit Analysis for its Zin";
+    DrawAnalysisProgress(seriesPanel.x + seriesPanel.width - 20.0f, seriesPanel.y + 14.0f);
     if (!seriesCircuit.empty()) {
-        DrawSeriesCircuitDiagram(seriesPanel.x + 20.0f, seriesPanel.y + 50.0f, seriesPanel.width - 40.0f);
+        DrawSeriesCircuitDiagram(seriesPanel.x + 20.0f, seriesPanel.y + 50.0f, seriesPanel.width - 40.0f, 110.0f);
 
-        double seriesR = CalcSeries(seriesCircuit);
-        double seriesZ = CalcSeriesImpedance(seriesCircuit, analysisFrequencyHz);
+        double seriesR = a.seriesR;
+        double seriesZ = a.seriesZ;
 
         // Bigger, separated results line
         float textY = seriesPanel.y + 165.0f;
         DrawTextEx(customFont, "SERIES RESULTS:",
             Vector2{ seriesPanel.x + 20, textY }, 18.0f, 1.0f, MakeColor(0, 77, 64, 255));
         textY += 22.0f;
-        DrawTextEx(customFont,
-            TextFormat("R = %.3f Ohm    |Z| = %.3f Ohm    f = %.0f Hz",
-                seriesR, seriesZ, analysisFrequencyHz),
+        if (seriesResultLine.Stale(seriesR, seriesZ, a.freqHz)) {
+            seriesResultLine.text = TextFormat("R = %.3f Ohm    |Z| = %.3f Ohm    f = %.0f Hz",
+                seriesR, seriesZ, a.freqHz);
+        }
+        DrawTextEx(customFont, general ? generalLine : seriesResultLine.text.c_str(),
             Vector2{ seriesPanel.x + 20, textY }, 16.0f, 1.0f, MakeColor(13, 71, 161, 255));
     }
     else {
@@ -802,18 +1132,20 @@ void DrawDisplayScreen(int w, int h) {
     DrawGlassPanel(parallelPanel, MakeColor(102, 187, 106, 255));
 
     if (!parallelCircuit.empty()) {
-        DrawParallelCircuitDiagram(parallelPanel.x + 20.0f, parallelPanel.y + 50.0f, parallelPanel.width - 40.0f);
+        DrawParallelCircuitDiagram(parallelPanel.x + 20.0f, parallelPanel.y + 50.0f, parallelPanel.width - 40.0f, 110.0f);
 
-        double parallelR = CalcParallel(parallelCircuit);
-        double parallelZ = CalcParallelImpedance(parallelCircuit, analysisFrequencyHz);
+        double parallelR = a.parallelR;
+        double parallelZ = a.parallelZ;
 
         float textY = parallelPanel.y + 165.0f;
         DrawTextEx(customFont, "PARALLEL RESULTS:",
             Vector2{ parallelPanel.x + 20, textY }, 18.0f, 1.0f, MakeColor(104, 66, 0, 255));
         textY += 22.0f;
-        DrawTextEx(customFont,
-            TextFormat("R = %.3f Ohm    |Z| = %.3f Ohm    f = %.0f Hz",
-                parallelR, parallelZ, analysisFrequencyHz),
+        if (parallelResultLine.Stale(parallelR, parallelZ, a.freqHz)) {
+            parallelResultLine.text = TextFormat("R = %.3f Ohm    |Z| = %.3f Ohm    f = %.0f Hz",
+                parallelR, parallelZ, a.freqHz);
+        }
+        DrawTextEx(customFont, general ? generalLine : parallelResultLine.text.c_str(),
             Vector2{ parallelPanel.x + 20, textY }, 16.0f, 1.0f, MakeColor(27, 94, 32, 255));
     }
     else {
@@ -822,25 +1154,96 @@ void DrawDisplayScreen(int w, int h) {
             16.0f, 1.0f, MakeColor(33, 53, 64, 255));
     }
 
-    EndDrawing();
 }
 //this portion reamended
 
-void DrawCalcScreen(int w, int h) {
-    BeginDrawing();
-    DrawGradientBackground(w, h);
-    DrawCommonTopBar(w, "Total Circuit Analysis");
-    DrawBackButton();
+// ranked d|Z|/dvalue rows shown on the report
+const int REPORT_SENS_ROWS = 8;
+
+void DrawSensitivityTable(Rectangle area, const std::vector<SensitivityEntry>& entries, int total, double z) {
+    Color textMain = MakeColor(245, 245, 245, 255);
+    Color textSub = MakeColor(200, 200, 200, 255);
+    Color up = MakeColor(255, 171, 145, 255);     // |Z| rises with the value
+    Color down = MakeColor(129, 212, 250, 255);   // |Z| falls with the value
+    DrawTextEx(customFont, TextFormat("SENSITIVITY of |Z| = %.3f Ohm (top %d of %d)",
+        z, std::min(REPORT_SENS_ROWS, (int)entries.size()), total),
+        Vector2{ area.x, area.y }, 14.0f, 1.0f, textMain);
+
+    const float cols[6] = { 0.0f, 50.0f, 110.0f, 220.0f, 360.0f, 520.0f };
+    const char* heads[6] = { "#", "ID", "Type", "Value", "d|Z|/dv", "%|Z| per %v" };
+    float y = area.y + 26.0f;
+    for (int c = 0; c < 6; ++c) {
+        DrawTextEx(customFont, heads[c], Vector2{ area.x + cols[c], y }, 12.0f, 1.0f, textSub);
+    }
+    y += 20.0f;
+    int rows = std::min(REPORT_SENS_ROWS, (int)entries.size());
+    float barX = area.x + cols[5] + 110.0f;
+    float barMax = std::max(0.0f, area.width - (barX - area.x));
+    for (int i = 0; i < rows; ++i) {
+        const SensitivityEntry& e = entries[i];
+        Color col = e.relative >= 0.0 ? up : down;
+        DrawTextEx(customFont, TextFormat("%d", i + 1), Vector2{ area.x + cols[0], y }, 12.0f, 1.0f, textSub);
+        DrawTextEx(customFont, TextFormat("%d", e.id), Vector2{ area.x + cols[1], y }, 12.0f, 1.0f, textMain);
+        DrawTextEx(customFont, TypeToString(e.type).c_str(), Vector2{ area.x + cols[2], y }, 12.0f, 1.0f, textMain);
+        DrawTextEx(customFont, TextFormat("%.4g", e.value), Vector2{ area.x + cols[3], y }, 12.0f, 1.0f, textMain);
+        DrawTextEx(customFont, TextFormat("%+.4g", e.dMag), Vector2{ area.x + cols[4], y }, 12.0f, 1.0f, col);
+        DrawTextEx(customFont, TextFormat("%+.3f", e.relative), Vector2{ area.x + cols[5], y }, 12.0f, 1.0f, col);
+        // relative sensitivity bar, full width at 1 (|Z| proportional to the value)
+        float bw = (float)std::min(1.0, std::fabs(e.relative)) * barMax;
+        DrawRectangleRec(Rectangle{ barX, y + 2.0f, bw, 10.0f }, col);
+        y += 20.0f;
+    }
+}
 
+void DrawMonteCarloHistogram(Rectangle area, const MonteCarloHistogram& hist, long long samples) {
+    Color textMain = MakeColor(245, 245, 245, 255);
+    Color bar = MakeColor(179, 157, 219, 255);   // light purple
+    Color pass = MakeColor(165, 214, 167, 255);
+    DrawTextEx(customFont,
+        TextFormat("MONTE CARLO (%lld samples): |Z| mean %.3f Ohm | std %.3f | yield %.1f%% within +-5%%",
+            samples, hist.mean, hist.stddev, 100.0 * MonteCarloYield(hist, samples)),
+        Vector2{ area.x, area.y }, 14.0f, 1.0f, textMain);
+
+    Rectangle plot = { area.x, area.y + 28.0f, area.width, area.height - 50.0f };
+    DrawRectangleLinesEx(plot, 1.0f, MakeColor(66, 66, 66, 255));
+    long long peak = 1;
+    for (long long c : hist.counts) peak = std::max(peak, c);
+    int bins = (int)hist.counts.size();
+    float bw = plot.width / std::max(1, bins);
+    double binWidth = (hist.hi - hist.lo) / std::max(1, bins);
+    for (int b = 0; b < bins; ++b) {
+        float bh = (float)((plot.height - 4.0f) * hist.counts[b] / (double)peak);
+        double center = hist.lo + (b + 0.5) * binWidth;
+        bool inBand = std::fabs(center - hist.nominal) <= 0.05 * hist.nominal;
+        DrawRectangleRec(Rectangle{ plot.x + b * bw + 1.0f, plot.y + plot.height - bh, bw - 2.0f, bh }, inBand ? pass : bar);
+    }
+    DrawTextEx(customFont, TextFormat("%.3f", hist.lo), Vector2{ plot.x, plot.y + plot.height + 6.0f },
+        12.0f, 1.0f, MakeColor(200, 200, 200, 255));
+    const char* hiText = TextFormat("%.3f", hist.hi);
+    DrawTextEx(customFont, hiText, Vector2{ plot.x + plot.width - MeasureTextEx(customFont, hiText, 12.0f, 1.0f).x,
+        plot.y + plot.height + 6.0f }, 12.0f, 1.0f, MakeColor(200, 200, 200, 255));
+}
+
+// the report panel and the newest analysis report, drawn with the panel at `panel`
+void DrawCalcReport(Rectangle panel) {
     // Very dark panel
-    Rectangle panel = { 40.0f, 120.0f, (float)w - 80.0f, (float)h - 180.0f };
     DrawRectangleRounded(panel, 0.1f, 16, MakeColor(33, 33, 33, 255));          // near‑black
     DrawRectangleRoundedLines(panel, 0.1f, 16, MakeColor(66, 66, 66, 255));
 
-    double seriesTotal = CalcSeries(seriesCircuit);
-    double parallelTotal = CalcParallel(parallelCircuit);
-    double seriesZ = CalcSeriesImpedance(seriesCircuit, analysisFrequencyHz);
-    double parallelZ = CalcParallelImpedance(parallelCircuit, analysisFrequencyHz);
+    if (!calcReport) {
+        DrawTextEx(customFont, "Circuit Analysis Report",
+            Vector2{ panel.x + 20, panel.y + 20 }, 16.0f, 1.0f, MakeColor(245, 245, 245, 255));
+        DrawTextEx(customFont, "Analyzing...",
+            Vector2{ panel.x + 20, panel.y + 55 }, 13.0f, 1.0f, MakeColor(200, 200, 200, 255));
+        return;
+    }
+    const AnalysisReport& report = *calcReport;
+    const AnalysisResult& a = report.analysis;
+    bool hasSeries = report.seriesCount > 0, hasParallel = report.parallelCount > 0;
+    double seriesTotal = a.seriesR;
+    double parallelTotal = a.parallelR;
+    double seriesZ = a.seriesZ;
+    double parallelZ = a.parallelZ;
 
     int y = (int)panel.y + 20;
 
@@ -854,72 +1257,484 @@ void DrawCalcScreen(int w, int h) {
         Vector2{ panel.x + 20, (float)y }, 16.0f, 1.0f, textMain);
     y += 35;
 
-    DrawTextEx(customFont, TextFormat("Frequency: %.1f Hz", analysisFrequencyHz),
+    DrawTextEx(customFont, TextFormat("Frequency: %.1f Hz", report.freqHz),
         Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textSub);
     y += 25;
 
-    DrawTextEx(customFont,
-        TextFormat("Series: %d components | R = %.3f Ohm | Z = %.3f Ohm",
-            (int)seriesCircuit.size(), seriesTotal, seriesZ),
-        Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textSeries);
-    y += 25;
-
-    DrawTextEx(customFont,
-        TextFormat("Parallel: %d components | R = %.3f Ohm | Z = %.3f Ohm",
-            (int)parallelCircuit.size(), parallelTotal, parallelZ),
-        Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textPar);
-    y += 35;
-
-    if (!seriesCircuit.empty() && !parallelCircuit.empty()) {
-        DrawTextEx(customFont, "COMBINED (Series + Parallel):",
+    if (report.hasNetwork) {
+        // an imported deck the two lists only approximate: their sums are not shown
+        DrawTextEx(customFont,
+            TextFormat("Imported network: %d components | Series / Parallel: n/a (general network)",
+                report.seriesCount + report.parallelCount),
+            Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textSub);
+        y += 35;
+        DrawTextEx(customFont, "INPUT IMPEDANCE (nodal analysis):",
             Vector2{ panel.x + 20, (float)y }, 14.0f, 1.0f, textWarn);
         y += 25;
-        double combined = seriesTotal + parallelTotal;
-        double combinedZ = seriesZ + parallelZ;
-        DrawTextEx(customFont,
-            TextFormat("Total R = %.3f Ohm | Total Z = %.3f Ohm", combined, combinedZ),
+        DrawTextEx(customFont, report.networkSolved
+            ? TextFormat("Zin = %.3f %+.3fj Ohm | |Zin| = %.3f Ohm | phase %.1f deg",
+                report.networkZ.real(), report.networkZ.imag(), std::abs(report.networkZ),
+                std::arg(report.networkZ) * 180.0 / M_PI)
+            : "Singular network (a node without a path to ground?)",
             Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textWarn);
     }
-    else if (!seriesCircuit.empty()) {
-        DrawTextEx(customFont, "Only Series Circuit (Resistance dominates)",
+    else {
+        DrawTextEx(customFont,
+            TextFormat("Series: %d components | R = %.3f Ohm | Z = %.3f Ohm",
+                report.seriesCount, seriesTotal, seriesZ),
             Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textSeries);
-    }
-    else if (!parallelCircuit.empty()) {
-        DrawTextEx(customFont, "Only Parallel Circuit (Resistance dominates)",
+        y += 25;
+
+        DrawTextEx(customFont,
+            TextFormat("Parallel: %d components | R = %.3f Ohm | Z = %.3f Ohm",
+                report.parallelCount, parallelTotal, parallelZ),
             Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textPar);
+        y += 35;
+
+        if (hasSeries && hasParallel) {
+            DrawTextEx(customFont, "COMBINED (Series + Parallel):",
+                Vector2{ panel.x + 20, (float)y }, 14.0f, 1.0f, textWarn);
+            y += 25;
+            double combined = seriesTotal + parallelTotal;
+            double combinedZ = a.combinedZ;
+            DrawTextEx(customFont,
+                TextFormat("Total R = %.3f Ohm | Total Z = %.3f Ohm", combined, combinedZ),
+                Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textWarn);
+        }
+        else if (hasSeries) {
+            DrawTextEx(customFont, "Only Series Circuit (Resistance dominates)",
+                Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textSeries);
+        }
+        else if (hasParallel) {
+            DrawTextEx(customFont, "Only Parallel Circuit (Resistance dominates)",
+                Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textPar);
+        }
+        else {
+            DrawTextEx(customFont, "No components added yet!",
+                Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textMain);
+        }
+    }
+
+    const MonteCarloResult& mc = report.monteCarlo;
+    if (mc.toleranced > 0) {
+        const MonteCarloHistogram& hist = (hasSeries && hasParallel) || report.hasNetwork ? mc.combined
+            : hasSeries ? mc.series : mc.parallel;
+        DrawMonteCarloHistogram(Rectangle{ panel.x + 20, (float)y + 50, panel.width - 40, 220.0f }, hist, mc.samples);
+        y += 260;
+    }
+
+    if (!report.sensitivity.empty()) {
+        DrawSensitivityTable(Rectangle{ panel.x + 20, (float)y + 50, panel.width - 40, 210.0f },
+            report.sensitivity, report.sensitivityCount, report.sensitivityZ);
+    }
+}
+
+// The report only changes when a new analysis report arrives, so it is drawn
+// once into a texture and idle frames just blit that: no formatting and no
+// glyph layout. Rendered outside any other texture mode (before BeginDrawing).
+struct ReportTexture {
+    bool ready = false;
+    RenderTexture2D target;
+    long long serial = -1;     // AnalysisReport drawn, 0 = none yet
+    int w = 0, h = 0;
+};
+
+long long CalcReportSerial() {
+    return calcReport ? calcReport->serial : 0;
+}
+
+ReportTexture reportTexture;
+
+bool ReportTextureCurrent(int w, int h) {
+    const ReportTexture& r = reportTexture;
+    return r.ready && r.serial == CalcReportSerial() && r.w == w && r.h == h;
+}
+
+Rectangle CalcReportPanel(int w, int h) {
+    return Rectangle{ 40.0f, 120.0f, (float)w - 80.0f, (float)h - 180.0f };
+}
+
+void UpdateReportTexture(int w, int h) {
+    if (ReportTextureCurrent(w, h)) return;
+    ReportTexture& r = reportTexture;
+
+    Rectangle panel = CalcReportPanel(w, h);
+    if (!r.ready || r.w != w || r.h != h) {
+        if (r.ready) UnloadRenderTexture(r.target);
+        r.target = LoadRenderTexture((int)panel.width, (int)panel.height);
+        r.ready = true;
+    }
+    BeginTextureMode(r.target);
+    ClearBackground(BLANK);
+    DrawCalcReport(Rectangle{ 0.0f, 0.0f, panel.width, panel.height });
+    EndTextureMode();
+    r.serial = CalcReportSerial();
+    r.w = w;
+    r.h = h;
+}
+
+void UnloadReportTexture() {
+    if (reportTexture.ready) UnloadRenderTexture(reportTexture.target);
+    reportTexture = ReportTexture();
+}
+
+void DrawCalcScreen(int w, int h) {
+    DrawGradientBackground(w, h);
+    DrawCommonTopBar(w, "Total Circuit Analysis");
+    DrawBackButton();
+
+    Rectangle panel = CalcReportPanel(w, h);
+    if (ReportTextureCurrent(w, h)) {
+        const Texture2D& t = reportTexture.target.texture;
+        // render textures are stored upside down
+        DrawTextureRec(t, Rectangle{ 0.0f, 0.0f, (float)t.width, -(float)t.height },
+            Vector2{ panel.x, panel.y }, WHITE);
     }
     else {
-        DrawTextEx(customFont, "No components added yet!",
-            Vector2{ panel.x + 20, (float)y }, 13.0f, 1.0f, textMain);
+        DrawCalcReport(panel);
     }
+    DrawAnalysisProgress(panel.x + panel.width - 20.0f, panel.y + 20.0f);
+}
 
-    EndDrawing();
+
+// ---------------------- Bode Plot -------------------------
+
+// display sweep: one point per ~2 px of plot width, recomputed only when
+// the circuit changes; the CSV export uses a much denser sweep
+SweepSettings bodeSettings = { 10.0, 1.0e6, 600, SweepScale::LOG };
+SweepSettings bodeExportSettings = { 10.0, 1.0e6, 100000, SweepScale::LOG };
+SweepResult bodeSweep;
+int bodeRevision = -1;
+std::vector<double> bodeSeriesDb;
+std::vector<double> bodeParallelDb;
+
+void UpdateBodeSweep() {
+    if (bodeRevision == circuitRevision) return;
+    RunSweep(bodeSettings, bodeSweep);
+    bodeSeriesDb.resize(bodeSweep.freqHz.size());
+    bodeParallelDb.resize(bodeSweep.freqHz.size());
+    for (size_t i = 0; i < bodeSweep.freqHz.size(); ++i) {
+        // floor at 1e-12 Ohm (-240 dB) so an empty circuit stays finite
+        bodeSeriesDb[i] = 20.0 * std::log10(std::max(bodeSweep.seriesMag[i], 1e-12));
+        bodeParallelDb[i] = 20.0 * std::log10(std::max(bodeSweep.parallelMag[i], 1e-12));
+    }
+    bodeRevision = circuitRevision;
+}
+
+float BodeX(Rectangle area, double freqHz) {
+    double t = std::log10(freqHz / bodeSettings.startHz) / std::log10(bodeSettings.stopHz / bodeSettings.startHz);
+    return area.x + (float)t * area.width;
+}
+
+float BodeY(Rectangle area, double v, double vMin, double vMax) {
+    double t = (v - vMin) / (vMax - vMin);
+    return area.y + area.height - (float)t * area.height;
+}
+
+void DrawBodeGrid(Rectangle area, double vMin, double vMax, const char* unit) {
+    DrawRectangleRec(area, MakeColor(255, 255, 255, 200));
+    Color grid = MakeColor(207, 216, 220, 255);
+    Color label = MakeColor(84, 110, 122, 255);
+
+    for (double f = bodeSettings.startHz; f <= bodeSettings.stopHz * 1.0001; f *= 10.0) {
+        float x = BodeX(area, f);
+        DrawLine((int)x, (int)area.y, (int)x, (int)(area.y + area.height), grid);
+        DrawTextEx(customFont, TextFormat(f >= 1000.0 ? "%.0fk" : "%.0f", f >= 1000.0 ? f / 1000.0 : f),
+            Vector2{ x - 8.0f, area.y + area.height + 4.0f }, 11.0f, 1.0f, label);
+    }
+    for (int k = 0; k <= 4; ++k) {
+        double v = vMin + (vMax - vMin) * k / 4.0;
+        float y = BodeY(area, v, vMin, vMax);
+        DrawLine((int)area.x, (int)y, (int)(area.x + area.width), (int)y, grid);
+        DrawTextEx(customFont, TextFormat("%.0f %s", v, unit),
+            Vector2{ area.x - 70.0f, y - 6.0f }, 11.0f, 1.0f, label);
+    }
+    DrawRectangleLines((int)area.x, (int)area.y, (int)area.width, (int)area.height, MakeColor(144, 164, 174, 255));
+}
+
+void DrawBodeTrace(Rectangle area, const std::vector<double>& v, double vMin, double vMax, Color color) {
+    size_t n = v.size();
+    if (n < 2) return;
+    float dx = area.width / (float)(n - 1);   // log sweep points are evenly spaced on a log axis
+    Vector2 prev = { area.x, BodeY(area, v[0], vMin, vMax) };
+    for (size_t i = 1; i < n; ++i) {
+        Vector2 cur = { area.x + dx * (float)i, BodeY(area, v[i], vMin, vMax) };
+        DrawLineEx(prev, cur, 2.0f, color);
+        prev = cur;
+    }
+}
+
+void DrawBodeScreen(int w, int h) {
+    UpdateBodeSweep();
+
+    DrawGradientBackground(w, h);
+    DrawCommonTopBar(w, "Frequency Sweep (Bode Plot)");
+    DrawBackButton();
+
+    Rectangle panel = { 40.0f, 130.0f, (float)w - 80.0f, (float)h - 190.0f };
+    DrawGlassPanel(panel, MakeColor(94, 53, 177, 255));
+
+    Color seriesColor = MakeColor(0, 150, 136, 255);
+    Color parallelColor = MakeColor(255, 152, 0, 255);
+    bool hasSeries = !seriesCircuit.empty();
+    bool hasParallel = !parallelCircuit.empty();
+
+    // magnitude axis auto-scales to whole 20 dB steps around both traces
+    double dbMin = 1e300, dbMax = -1e300;
+    for (size_t i = 0; i < bodeSweep.freqHz.size(); ++i) {
+        if (hasSeries) { dbMin = std::min(dbMin, bodeSeriesDb[i]); dbMax = std::max(dbMax, bodeSeriesDb[i]); }
+        if (hasParallel) { dbMin = std::min(dbMin, bodeParallelDb[i]); dbMax = std::max(dbMax, bodeParallelDb[i]); }
+    }
+    if (dbMin > dbMax) { dbMin = -20.0; dbMax = 60.0; }
+    dbMin = std::floor(dbMin / 20.0) * 20.0;
+    dbMax = std::ceil(dbMax / 20.0) * 20.0;
+    if (dbMax - dbMin < 20.0) dbMax = dbMin + 20.0;
+
+    float plotX = panel.x + 90.0f;
+    float plotW = panel.width - 120.0f;
+    float plotH = (panel.height - 150.0f) / 2.0f;
+    Rectangle magArea = { plotX, panel.y + 50.0f, plotW, plotH };
+    Rectangle phaseArea = { plotX, magArea.y + plotH + 50.0f, plotW, plotH };
+
+    DrawTextEx(customFont, "|Z| (dB Ohm)", Vector2{ plotX, magArea.y - 24.0f }, 16.0f, 1.0f, MakeColor(38, 70, 83, 255));
+    DrawBodeGrid(magArea, dbMin, dbMax, "dB");
+    if (hasSeries) DrawBodeTrace(magArea, bodeSeriesDb, dbMin, dbMax, seriesColor);
+    if (hasParallel) DrawBodeTrace(magArea, bodeParallelDb, dbMin, dbMax, parallelColor);
+
+    DrawTextEx(customFont, "Phase (deg)", Vector2{ plotX, phaseArea.y - 24.0f }, 16.0f, 1.0f, MakeColor(38, 70, 83, 255));
+    DrawBodeGrid(phaseArea, -90.0, 90.0, "deg");
+    if (hasSeries) DrawBodeTrace(phaseArea, bodeSweep.seriesPhase, -90.0, 90.0, seriesColor);
+    if (hasParallel) DrawBodeTrace(phaseArea, bodeSweep.parallelPhase, -90.0, 90.0, parallelColor);
+
+    // analysis frequency marker
+    float fx = BodeX(magArea, analysisFrequencyHz);
+    if (fx >= magArea.x && fx <= magArea.x + magArea.width) {
+        DrawLine((int)fx, (int)magArea.y, (int)fx, (int)(phaseArea.y + phaseArea.height), MakeColor(244, 81, 30, 160));
+    }
+
+    float legendY = panel.y + 14.0f;
+    DrawRectangle((int)(panel.x + panel.width - 330.0f), (int)legendY + 6, 18, 4, seriesColor);
+    DrawTextEx(customFont, "Series", Vector2{ panel.x + panel.width - 305.0f, legendY }, 14.0f, 1.0f, seriesColor);
+    DrawRectangle((int)(panel.x + panel.width - 230.0f), (int)legendY + 6, 18, 4, parallelColor);
+    DrawTextEx(customFont, "Parallel", Vector2{ panel.x + panel.width - 205.0f, legendY }, 14.0f, 1.0f, parallelColor);
+    DrawTextEx(customFont, TextFormat("%.0f Hz - %.0f kHz, log", bodeSettings.startHz, bodeSettings.stopHz / 1000.0),
+        Vector2{ panel.x + 20.0f, legendY }, 14.0f, 1.0f, MakeColor(55, 71, 79, 255));
+
+    Rectangle exportBtn = { 140.0f, 85.0f, 150.0f, 35.0f };
+    Vector2 m = GetMousePosition();
+    bool hExport = CheckCollisionPointRec(m, exportBtn);
+    DrawButtonEx(exportBtn, "Export CSV", hExport, MakeColor(94, 53, 177, 220));
+    if (hExport && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+        statusMessage = WriteSweepCsv("bode_sweep.csv", bodeExportSettings)
+            ? "Saved 100000-point sweep to bode_sweep.csv"
+            : "Could not write bode_sweep.csv";
+    }
+    DrawTextEx(customFont, statusMessage.c_str(), Vector2{ 310.0f, 95.0f }, 14.0f, 1.0f, MakeColor(55, 71, 79, 255));
+
+}
+
+// ---------------------- Benchmarks -------------------------
+
+// every screen drawn into an offscreen RenderTexture. EndTextureMode flushes
+// the batch, so this is the CPU cost of building and submitting a frame.
+void AddScreenBenchCases(std::vector<BenchCase>& cases, const RenderTexture2D& target, int w, int h) {
+    struct ScreenBench { const char* name; void (*draw)(int, int); };
+    const ScreenBench screens[] = {
+        { "DrawMainMenu", DrawMainMenu },
+        { "DrawAddScreen", DrawAddScreen },
+        { "DrawRemoveScreen", DrawRemoveScreen },
+        { "DrawSearchScreen", DrawSearchScreen },
+        { "DrawDisplayScreen", DrawDisplayScreen },
+        { "DrawCalcScreen", DrawCalcScreen },
+        { "DrawBodeScreen", DrawBodeScreen },
+    };
+    for (const ScreenBench& sb : screens) {
+        cases.push_back({ sb.name,
+            [](int n) -> long long {
+                BuildBenchCircuit(n);
+                searchedId = n / 2;   // the search screen shows a hit
+                // the report of this circuit is ready before timing starts
+                UpdateCalcAnalysis(true);
+                WaitAnalysisIdle();
+                UpdateCalcAnalysis(true);
+                return 0;
+            },
+            [&target, sb, w, h] {
+                UpdateCalcAnalysis(true);
+                UpdateReportTexture(w, h);
+                BeginTextureMode(target);
+                sb.draw(w, h);
+                EndTextureMode();
+            } });
+    }
+}
+
+// "--bench [--sizes ...] [--budget-ms N] [--filter text]": core cases plus
+// the screens, in a hidden window
+int RunGuiBenchmarks(int argc, char** argv, int w, int h) {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(w, h, "Electronic Circuit Analyzer - benchmarks");
+    customFont = LoadFontEx("f1.ttf", 32, nullptr, 0);
+    BakeSymbolAtlas();
+    RenderTexture2D target = LoadRenderTexture(w, h);
+    StartAnalysisWorker();
+
+    std::vector<BenchCase> cases;
+    AddCoreBenchCases(cases);
+    AddScreenBenchCases(cases, target, w, h);
+    int rc = RunBenchmarks(argc, argv, cases);
+
+    StopAnalysisWorker();
+    UnloadRenderTexture(target);
+    UnloadReportTexture();
+    UnloadSymbolAtlas();
+    UnloadFont(customFont);
+    CloseWindow();
+    return rc;
 }
 
+// ---------------------- Frame Loop -------------------------
+
+// ON_DEMAND redraws only after input, a resize, a circuit/frequency
+// change or analysis progress, into frameCache; other frames just present that texture, and
+// while nothing is pending EndDrawing sleeps until the next input event.
+struct FrameCache {
+    bool ready = false;
+    RenderTexture2D target;
+    int pending = 0;          // frames still to redraw
+    int revision = -1;        // state the cache was drawn from
+    double freqHz = 0.0;
+    ScreenState screen = ScreenState::MAIN_MENU;
+};
+
+FrameCache frameCache;
+
+void DrawCurrentScreen(int w, int h) {
+    switch (currentScreen) {
+    case ScreenState::MAIN_MENU:      DrawMainMenu(w, h); break;
+    case ScreenState::ADD_COMPONENT:  DrawAddScreen(w, h); break;
+    case ScreenState::REMOVE_COMPONENT: DrawRemoveScreen(w, h); break;
+    case ScreenState::SEARCH_COMPONENT: DrawSearchScreen(w, h); break;
+    case ScreenState::DISPLAY_ALL:    DrawDisplayScreen(w, h); break;
+    case ScreenState::CALC_RESISTANCE: DrawCalcScreen(w, h); break;
+    case ScreenState::BODE_PLOT:      DrawBodeScreen(w, h); break;
+    }
+}
+
+// anything the screens react to: pointer, wheel, buttons or keys
+bool FrameInputChanged() {
+    Vector2 d = GetMouseDelta();
+    if (d.x != 0.0f || d.y != 0.0f || GetMouseWheelMove() != 0.0f) return true;
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_MIDDLE; ++b) {
+        if (IsMouseButtonDown(b) || IsMouseButtonReleased(b)) return true;
+    }
+    for (int k = KEY_SPACE; k <= KEY_KB_MENU; ++k) {
+        if (IsKeyDown(k) || IsKeyReleased(k)) return true;
+    }
+    return false;
+}
+
+void SetRenderMode(RenderMode mode) {
+    renderMode = mode;
+    frameCache.pending = 2;
+    if (mode == RenderMode::CONTINUOUS) DisableEventWaiting();
+}
+
+void UnloadFrameCache() {
+    if (frameCache.ready) UnloadRenderTexture(frameCache.target);
+    frameCache = FrameCache();
+}
+
+void RunFrame(int w, int h) {
+    frameStartTime = GetTime();
+    frameStartAllocs = AllocationCount();
+    HandleDroppedFiles();
+    if (IsKeyPressed(KEY_F4)) {
+        SetRenderMode(renderMode == RenderMode::CONTINUOUS ? RenderMode::ON_DEMAND : RenderMode::CONTINUOUS);
+    }
+
+    bool analysisActive = UpdateCalcAnalysis(currentScreen == ScreenState::CALC_RESISTANCE ||
+        currentScreen == ScreenState::DISPLAY_ALL);
+
+    if (renderMode == RenderMode::CONTINUOUS) {
+        if (currentScreen == ScreenState::CALC_RESISTANCE) UpdateReportTexture(w, h);
+        BeginDrawing();
+        DrawCurrentScreen(w, h);
+        DrawFrameStats(w);
+        EndDrawing();
+        return;
+    }
+
+    FrameCache& fc = frameCache;
+    if (IsWindowResized() && fc.ready) {
+        UnloadRenderTexture(fc.target);
+        fc.ready = false;
+    }
+    if (!fc.ready) {
+        fc.target = LoadRenderTexture(w, h);
+        fc.ready = true;
+        fc.pending = 2;
+    }
+    // two frames per change: the screens handle input while drawing, so the
+    // second one shows what the first one's clicks and keys changed. An
+    // outstanding analysis keeps frames coming for its progress bar and result.
+    if (FrameInputChanged() || fc.revision != circuitRevision || fc.freqHz != analysisFrequencyHz ||
+        fc.screen != currentScreen || analysisActive) {
+        fc.pending = 2;
+    }
+
+    if (fc.pending > 0) {
+        fc.pending--;
+        if (currentScreen == ScreenState::CALC_RESISTANCE) UpdateReportTexture(w, h);
+        BeginTextureMode(fc.target);
+        DrawCurrentScreen(w, h);
+        EndTextureMode();
+        fc.revision = circuitRevision;
+        fc.freqHz = analysisFrequencyHz;
+        fc.screen = currentScreen;
+    }
+    if (fc.pending > 0) DisableEventWaiting();
+    else EnableEventWaiting();
+
+    BeginDrawing();
+    const Texture2D& t = fc.target.texture;
+    DrawTextureRec(t, Rectangle{ 0.0f, 0.0f, (float)t.width, -(float)t.height }, Vector2{ 0.0f, 0.0f }, WHITE);
+    DrawFrameStats(w);
+    EndDrawing();
+}
 
 // ---------------------- MAIN -------------------------
 
-int main() {
+int main(int argc, char** argv) {
     const int screenWidth = 1280;
     const int screenHeight = 900;
 
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--headless") return RunHeadless(argc, argv);
+        if (a == "--bench") return RunGuiBenchmarks(argc, argv, screenWidth, screenHeight);
+        if (a == "--render" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            renderMode = mode == "continuous" ? RenderMode::CONTINUOUS : RenderMode::ON_DEMAND;
+        }
+    }
+
     InitWindow(screenWidth, screenHeight, "Electronic Circuit Analyzer - Group 13 (Light Theme)");
     // instead of LoadFont("f1.ttf");
     customFont = LoadFontEx("f1.ttf", 32, nullptr, 0);   // bigger base size [web:70]
+    BakeSymbolAtlas();
+    StartAnalysisWorker();
 
     SetTargetFPS(60);
 
     while (!WindowShouldClose()) {
-        switch (currentScreen) {
-        case ScreenState::MAIN_MENU:      DrawMainMenu(screenWidth, screenHeight); break;
-        case ScreenState::ADD_COMPONENT:  DrawAddScreen(screenWidth, screenHeight); break;
-        case ScreenState::REMOVE_COMPONENT: DrawRemoveScreen(screenWidth, screenHeight); break;
-        case ScreenState::SEARCH_COMPONENT: DrawSearchScreen(screenWidth, screenHeight); break;
-        case ScreenState::DISPLAY_ALL:    DrawDisplayScreen(screenWidth, screenHeight); break;
-        case ScreenState::CALC_RESISTANCE: DrawCalcScreen(screenWidth, screenHeight); break;
-        }
+        RunFrame(screenWidth, screenHeight);
     }
 
+    StopAnalysisWorker();
+    UnloadFrameCache();
+    UnloadReportTexture();
+    UnloadSymbolAtlas();
     UnloadFont(customFont);
     CloseWindow();
     return 0;
@@ -0,0 +1,75 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - read-only memory-mapped files
+ ********************************************************************/
+
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+bool MapFile(const char* path, MappedFile& mf) {
+    mf = MappedFile();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return false; }
+    mf.file = file;
+    if (size.QuadPart == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { UnmapFile(mf); return false; }
+    mf.mapping = mapping;
+    mf.data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mf.data) { UnmapFile(mf); return false; }
+    mf.size = (size_t)size.QuadPart;
+    return true;
+}
+
+void UnmapFile(MappedFile& mf) {
+    if (mf.data) UnmapViewOfFile(mf.data);
+    if (mf.mapping) CloseHandle((HANDLE)mf.mapping);
+    if (mf.file) CloseHandle((HANDLE)mf.file);
+    mf = MappedFile();
+}
+
+// plain rename() refuses to replace an existing file here
+bool ReplaceFileWith(const char* to, const char* from) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MapFile(const char* path, MappedFile& mf) {
+    mf = MappedFile();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    if (st.st_size == 0) { close(fd); return true; }
+
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // the mapping keeps the file open
+    if (p == MAP_FAILED) return false;
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    mf.data = (const char*)p;
+    mf.size = (size_t)st.st_size;
+    return true;
+}
+
+void UnmapFile(MappedFile& mf) {
+    if (mf.data) munmap((void*)mf.data, mf.size);
+    mf = MappedFile();
+}
+
+bool ReplaceFileWith(const char* to, const char* from) {
+    return std::rename(from, to) == 0;
+}
+#endif
@@ -0,0 +1,26 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - read-only memory-mapped files
+ *
+ * The loaders read their input straight out of the page cache
+ * instead of copying it through stdio buffers.
+ ********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+struct MappedFile {
+    const char* data = nullptr;   // nullptr for an empty file
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;         // HANDLEs
+    void* mapping = nullptr;
+#endif
+};
+
+bool MapFile(const char* path, MappedFile& mf);
+void UnmapFile(MappedFile& mf);
+
+// moves `from` over `to` in one step (rename / MoveFileEx); on failure
+// both files are left as they were
+bool ReplaceFileWith(const char* to, const char* from);
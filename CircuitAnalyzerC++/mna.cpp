@@ -0,0 +1,387 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - modified nodal analysis
+ ********************************************************************/
+
+#include "mna.h"
+#include "parallel.h"
+#include <algorithm>
+#include <queue>
+#include <cmath>
+
+void AddNetElement(Network& net, ComponentType type, double value, int nodeA, int nodeB) {
+    int id = (int)net.elements.size() + 1;
+    net.elements.push_back(NetElement{ Component(id, type, value, CircuitType::SERIES), nodeA, nodeB });
+    net.nodeCount = std::max(net.nodeCount, std::max(nodeA, nodeB) + 1);
+}
+
+void BuildNetworkFromCircuits(Network& net) {
+    net = Network();
+    int node = 1;
+    for (auto it = seriesCircuit.begin(); it != seriesCircuit.end(); ++it) {
+        const Component* c = FindComponent(*it);
+        if (!c) continue;
+        // the last series part goes straight to ground when there is no bank
+        bool last = std::next(it) == seriesCircuit.end() && parallelCircuit.empty();
+        net.elements.push_back(NetElement{ *c, node, last ? 0 : node + 1 });
+        if (!last) node++;
+    }
+    for (int id : parallelCircuit) {
+        const Component* c = FindComponent(id);
+        if (c) net.elements.push_back(NetElement{ *c, node, 0 });
+    }
+    net.nodeCount = node + 1;
+}
+
+void LoadCircuitsFromNetwork(const Network& net) {
+    ClearCircuit();
+    for (const NetElement& e : net.elements) {
+        bool grounded = e.nodeA == 0 || e.nodeB == 0;
+        AppendComponent(e.comp.type, e.comp.value, grounded ? CircuitType::PARALLEL : CircuitType::SERIES);
+    }
+}
+
+// walks the ungrounded elements as one path from inputNode; every grounded
+// element must then hang off the path's far end (the parallel bank)
+bool IsSeriesParallelNetwork(const Network& net) {
+    if (net.elements.empty()) return true;
+    int nodes = net.nodeCount;
+    if (net.inputNode <= 0 || net.inputNode >= nodes) return false;
+    std::vector<int> start(nodes + 1, 0);
+    int grounded = 0;
+    for (const NetElement& e : net.elements) {
+        if (e.nodeA < 0 || e.nodeB < 0 || e.nodeA >= nodes || e.nodeB >= nodes) return false;
+        if (e.nodeA == 0 && e.nodeB == 0) return false;
+        if (e.nodeA == 0 || e.nodeB == 0) { ++grounded; continue; }
+        ++start[e.nodeA + 1];
+        ++start[e.nodeB + 1];
+    }
+    if (grounded == 0) return false;   // open chain: the lists would close it to ground
+    for (int v = 0; v < nodes; ++v) start[v + 1] += start[v];
+    std::vector<int> incident(start[nodes]);
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for (int k = 0; k < (int)net.elements.size(); ++k) {
+        const NetElement& e = net.elements[k];
+        if (e.nodeA == 0 || e.nodeB == 0) continue;
+        incident[fill[e.nodeA]++] = k;
+        incident[fill[e.nodeB]++] = k;
+    }
+
+    std::vector<char> used(net.elements.size(), 0);
+    std::vector<char> seen(nodes, 0);
+    int node = net.inputNode;
+    int chain = 0;
+    while (true) {
+        seen[node] = 1;
+        int next = -1;
+        for (int i = start[node]; i < start[node + 1]; ++i) {
+            int k = incident[i];
+            if (used[k]) continue;
+            if (next >= 0) return false;   // a branch off the chain
+            next = k;
+        }
+        if (next < 0) break;
+        used[next] = 1;
+        ++chain;
+        const NetElement& e = net.elements[next];
+        node = e.nodeA == node ? e.nodeB : e.nodeA;
+        if (seen[node]) return false;      // a loop
+    }
+    if (chain != (int)net.elements.size() - grounded) return false;
+    for (const NetElement& e : net.elements) {
+        if ((e.nodeA == 0 || e.nodeB == 0) && e.nodeA + e.nodeB != node) return false;
+    }
+    return true;
+}
+
+// ---------------------- Ordering -------------------------
+
+// Minimum degree on an explicit elimination graph: eliminating v turns its
+// remaining neighbours into a clique. Eliminated nodes are dropped from a
+// list whenever it is rewritten.
+void MinimumDegreeOrder(int n, std::vector<std::vector<int> >& adj, std::vector<int>& P) {
+    std::vector<int> deg(n);
+    std::vector<char> done(n, 0);
+    typedef std::pair<int, int> Entry;   // (degree, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > pq;
+    for (int i = 0; i < n; ++i) {
+        deg[i] = (int)adj[i].size();
+        pq.push(Entry(deg[i], i));
+    }
+
+    P.clear();
+    std::vector<int> nb, merged;
+    while (!pq.empty()) {
+        Entry e = pq.top();
+        pq.pop();
+        int v = e.second;
+        if (done[v] || e.first != deg[v]) continue;   // stale entry
+        done[v] = 1;
+        P.push_back(v);
+
+        nb.clear();
+        for (int u : adj[v]) if (!done[u]) nb.push_back(u);
+        // neighbours of v become a clique: merge nb into each adjacency
+        // list in one pass (both sorted) instead of inserting one by one
+        for (int u : nb) {
+            std::vector<int>& au = adj[u];
+            merged.clear();
+            merged.reserve(au.size() + nb.size());
+            size_t a = 0, b = 0;
+            int live = 0;
+            while (a < au.size() || b < nb.size()) {
+                int x;
+                if (b == nb.size() || (a < au.size() && au[a] < nb[b])) x = au[a++];
+                else if (a == au.size() || nb[b] < au[a]) x = nb[b++];
+                else { x = au[a++]; b++; }
+                if (x == u || done[x]) continue;
+                merged.push_back(x);
+                live++;
+            }
+            au.swap(merged);
+            deg[u] = live;
+            pq.push(Entry(deg[u], u));
+        }
+        std::vector<int>().swap(adj[v]);
+    }
+}
+
+// ---------------------- Symbolic Analysis -------------------------
+
+int FindSlot(const MnaSymbolic& sym, int row, int col) {
+    auto first = sym.Ai.begin() + sym.Ap[col];
+    auto last = sym.Ai.begin() + sym.Ap[col + 1];
+    return (int)(std::lower_bound(first, last, row) - sym.Ai.begin());
+}
+
+bool AnalyzeNetwork(const Network& net, MnaSymbolic& sym) {
+    int n = net.nodeCount - 1;
+    if (n <= 0 || net.inputNode <= 0 || net.inputNode >= net.nodeCount) return false;
+    sym.n = n;
+
+    // pattern of Y: every node has a diagonal, every element between
+    // two non-ground nodes adds a symmetric pair
+    std::vector<std::vector<int> > adj(n);
+    for (const NetElement& e : net.elements) {
+        int a = e.nodeA - 1, b = e.nodeB - 1;
+        if (a >= 0 && b >= 0 && a != b) {
+            adj[a].push_back(b);
+            adj[b].push_back(a);
+        }
+    }
+    sym.Ap.assign(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        std::vector<int>& ai = adj[i];
+        std::sort(ai.begin(), ai.end());
+        ai.erase(std::unique(ai.begin(), ai.end()), ai.end());
+        sym.Ap[i + 1] = sym.Ap[i] + (int)ai.size() + 1;
+    }
+    sym.Ai.resize(sym.Ap[n]);
+    for (int i = 0; i < n; ++i) {
+        auto out = sym.Ai.begin() + sym.Ap[i];
+        auto pos = std::lower_bound(adj[i].begin(), adj[i].end(), i);
+        out = std::copy(adj[i].begin(), pos, out);
+        *out++ = i;
+        std::copy(pos, adj[i].end(), out);
+    }
+
+    sym.diagSlot.resize(n);
+    for (int i = 0; i < n; ++i) sym.diagSlot[i] = FindSlot(sym, i, i);
+    sym.elemSlots.assign(net.elements.size() * 4, -1);
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        int a = net.elements[k].nodeA - 1, b = net.elements[k].nodeB - 1;
+        if (a == b) continue;   // shorted element, no effect on Y
+        if (a >= 0) sym.elemSlots[4 * k + 0] = sym.diagSlot[a];
+        if (b >= 0) sym.elemSlots[4 * k + 1] = sym.diagSlot[b];
+        if (a >= 0 && b >= 0) {
+            sym.elemSlots[4 * k + 2] = FindSlot(sym, a, b);
+            sym.elemSlots[4 * k + 3] = FindSlot(sym, b, a);
+        }
+    }
+
+    // nodes with no conducting path to ground get gmin, everything else is
+    // left exact (a blanket gmin visibly shifts |Z| of high-impedance chains)
+    std::vector<int> root(n + 1);
+    for (int i = 0; i <= n; ++i) root[i] = i;
+    auto findRoot = [&](int x) {
+        while (root[x] != x) x = root[x] = root[root[x]];
+        return x;
+    };
+    for (const NetElement& e : net.elements) root[findRoot(e.nodeA)] = findRoot(e.nodeB);
+    sym.gminSlots.clear();
+    for (int i = 0; i < n; ++i) {
+        if (findRoot(i + 1) != findRoot(0)) sym.gminSlots.push_back(sym.diagSlot[i]);
+    }
+
+    MinimumDegreeOrder(n, adj, sym.P);
+    sym.Pinv.resize(n);
+    for (int k = 0; k < n; ++k) sym.Pinv[sym.P[k]] = k;
+
+    // elimination tree and column counts of L (LDL symbolic, Davis)
+    sym.Parent.assign(n, -1);
+    sym.Lnz.assign(n, 0);
+    std::vector<int> flag(n, -1);
+    for (int k = 0; k < n; ++k) {
+        flag[k] = k;
+        int kk = sym.P[k];
+        for (int p = sym.Ap[kk]; p < sym.Ap[kk + 1]; ++p) {
+            int i = sym.Pinv[sym.Ai[p]];
+            for (; i < k && flag[i] != k; i = sym.Parent[i]) {
+                if (sym.Parent[i] == -1) sym.Parent[i] = k;
+                sym.Lnz[i]++;
+                flag[i] = k;
+            }
+        }
+    }
+    sym.Lp.assign(n + 1, 0);
+    for (int k = 0; k < n; ++k) sym.Lp[k + 1] = sym.Lp[k] + sym.Lnz[k];
+    return true;
+}
+
+void PrepareWorkspace(const MnaSymbolic& sym, MnaWorkspace& ws) {
+    int n = sym.n;
+    ws.Ax.assign(sym.Ai.size(), cd(0.0, 0.0));
+    ws.Li.resize(sym.Lp[n]);
+    ws.Lx.resize(sym.Lp[n]);
+    ws.D.resize(n);
+    ws.Y.assign(n, cd(0.0, 0.0));
+    ws.X.resize(n);
+    ws.Lnz.resize(n);
+    ws.Pattern.resize(n);
+    ws.Flag.resize(n);
+}
+
+// ---------------------- Numeric Solve -------------------------
+
+void EvalElementAdmittances(const Network& net, double freqHz, cd* y) {
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        Component c = net.elements[k].comp;
+        cd z = GetComponentImpedanceComplex(&c, freqHz);
+        // an ideal short (R = 0, or L at DC) becomes a very large conductance
+        y[k] = (z != cd(0.0, 0.0)) ? cd(1.0, 0.0) / z : cd(1e12, 0.0);
+    }
+}
+
+void AssembleNodalMatrix(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws, const cd* y) {
+    if (ws.Ax.size() != sym.Ai.size() || (int)ws.D.size() != sym.n) PrepareWorkspace(sym, ws);
+    std::fill(ws.Ax.begin(), ws.Ax.end(), cd(0.0, 0.0));
+    for (int slot : sym.gminSlots) ws.Ax[slot] += MNA_GMIN;
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        const int* s = &sym.elemSlots[4 * k];
+        if (s[0] >= 0) ws.Ax[s[0]] += y[k];
+        if (s[1] >= 0) ws.Ax[s[1]] += y[k];
+        if (s[2] >= 0) { ws.Ax[s[2]] -= y[k]; ws.Ax[s[3]] -= y[k]; }
+    }
+}
+
+bool FactorNodalMatrix(const MnaSymbolic& sym, MnaWorkspace& ws) {
+    int n = sym.n;
+    // up-looking L D L^T of P Y P^T (no conjugation: Y is complex symmetric)
+    for (int k = 0; k < n; ++k) {
+        ws.Y[k] = 0.0;
+        int top = n;
+        ws.Flag[k] = k;
+        ws.Lnz[k] = 0;
+        int kk = sym.P[k];
+        for (int p = sym.Ap[kk]; p < sym.Ap[kk + 1]; ++p) {
+            int i = sym.Pinv[sym.Ai[p]];
+            if (i > k) continue;
+            ws.Y[i] += ws.Ax[p];
+            int len = 0;
+            for (; ws.Flag[i] != k; i = sym.Parent[i]) {
+                ws.Pattern[len++] = i;
+                ws.Flag[i] = k;
+            }
+            while (len > 0) ws.Pattern[--top] = ws.Pattern[--len];
+        }
+        ws.D[k] = ws.Y[k];
+        ws.Y[k] = 0.0;
+        for (; top < n; ++top) {
+            int i = ws.Pattern[top];
+            cd yi = ws.Y[i];
+            ws.Y[i] = 0.0;
+            int p2 = sym.Lp[i] + ws.Lnz[i];
+            for (int p = sym.Lp[i]; p < p2; ++p) ws.Y[ws.Li[p]] -= ws.Lx[p] * yi;
+            cd lki = yi / ws.D[i];
+            ws.D[k] -= lki * yi;
+            ws.Li[p2] = k;
+            ws.Lx[p2] = lki;
+            ws.Lnz[i]++;
+        }
+        if (ws.D[k] == cd(0.0, 0.0)) return false;
+    }
+    return true;
+}
+
+void SolveFactored(const MnaSymbolic& sym, const MnaWorkspace& ws, cd* x) {
+    int n = sym.n;
+    for (int j = 0; j < n; ++j) {
+        for (int p = sym.Lp[j]; p < sym.Lp[j + 1]; ++p) x[ws.Li[p]] -= ws.Lx[p] * x[j];
+    }
+    for (int j = 0; j < n; ++j) x[j] /= ws.D[j];
+    for (int j = n - 1; j >= 0; --j) {
+        for (int p = sym.Lp[j]; p < sym.Lp[j + 1]; ++p) x[j] -= ws.Lx[p] * x[ws.Li[p]];
+    }
+}
+
+bool SolveInputImpedance(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws,
+    double freqHz, cd& zIn) {
+    ws.y.resize(net.elements.size());
+    EvalElementAdmittances(net, freqHz, ws.y.data());
+    AssembleNodalMatrix(net, sym, ws, ws.y.data());
+    if (!FactorNodalMatrix(sym, ws)) return false;
+
+    // 1 A into the input node: solve L D L^T x = P e_in
+    std::fill(ws.X.begin(), ws.X.end(), cd(0.0, 0.0));
+    ws.X[sym.Pinv[net.inputNode - 1]] = 1.0;
+    SolveFactored(sym, ws, ws.X.data());
+    zIn = ws.X[sym.Pinv[net.inputNode - 1]];
+    return true;
+}
+
+// ---------------------- Network Sweep -------------------------
+
+void SolveSweepRange(const Network& net, const MnaSymbolic& sym, std::vector<MnaWorkspace>& workspaces,
+    const SweepSettings& settings, int first, int count, int threads, cd* zOut) {
+    // the symbolic analysis is shared read-only; every worker factors into its
+    // own workspace and writes straight into its slice of zOut
+    ParallelFor(count, threads, 16, [&](int begin, int end, int worker) {
+        MnaWorkspace& ws = workspaces[worker];
+        for (int i = begin; i < end; ++i) {
+            cd z;
+            if (!SolveInputImpedance(net, sym, ws, SweepFrequencyAt(settings, first + i), z)) z = cd(NAN, NAN);
+            zOut[i] = z;
+        }
+    });
+}
+
+bool RunNetworkSweep(const Network& net, const SweepSettings& settings, int threads, std::vector<cd>& zOut) {
+    if (!SweepSettingsValid(settings)) return false;
+    MnaSymbolic sym;
+    if (!AnalyzeNetwork(net, sym)) return false;
+    std::vector<MnaWorkspace> workspaces(threads < 1 ? 1 : threads);
+
+    zOut.resize(settings.points);
+    SolveSweepRange(net, sym, workspaces, settings, 0, settings.points, threads, zOut.data());
+    return true;
+}
+
+bool WriteNetworkSweepCsv(FILE* out, const Network& net, const SweepSettings& settings, int threads) {
+    if (!SweepSettingsValid(settings)) return false;
+    MnaSymbolic sym;
+    if (!AnalyzeNetwork(net, sym)) return false;
+    std::vector<MnaWorkspace> workspaces(threads < 1 ? 1 : threads);
+
+    // solve a block in parallel, then write it; memory stays O(block)
+    const int block = 4096;
+    std::vector<cd> z(block);
+    fprintf(out, "freq_hz,zin_mag_ohm,zin_phase_deg\n");
+    for (int b = 0; b < settings.points; b += block) {
+        int m = (settings.points - b < block) ? settings.points - b : block;
+        SolveSweepRange(net, sym, workspaces, settings, b, m, threads, z.data());
+        for (int i = 0; i < m; ++i) {
+            fprintf(out, "%.6g,%.6g,%.3f\n", SweepFrequencyAt(settings, b + i),
+                std::abs(z[i]), std::arg(z[i]) * (180.0 / M_PI));
+        }
+    }
+    return !ferror(out);
+}
@@ -0,0 +1,97 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - modified nodal analysis
+ *
+ * General R/L/C networks on numbered nodes (0 = ground). The input
+ * impedance seen between inputNode and ground is found by injecting
+ * 1 A and solving the complex nodal system Y v = i.
+ *
+ * Y is complex symmetric, so it is factored as L D L^T with a sparse
+ * up-looking factorization. The ordering (minimum degree), elimination
+ * tree and nonzero pattern depend only on the topology and are computed
+ * once (MnaSymbolic); every frequency only redoes the numeric part in
+ * an MnaWorkspace.
+ ********************************************************************/
+
+#pragma once
+
+#include "circuitcore.h"
+#include "sweep.h"
+#include <vector>
+#include <cstdio>
+
+// one two-terminal component of a node-based netlist
+struct NetElement {
+    Component comp;
+    int nodeA;
+    int nodeB;
+};
+
+struct Network {
+    int nodeCount = 1;        // nodes 0..nodeCount-1, node 0 is ground
+    int inputNode = 1;        // impedance is measured from here to ground
+    std::vector<NetElement> elements;
+};
+
+// topology-only part of the solve, shared by every frequency
+struct MnaSymbolic {
+    int n = 0;                         // unknowns = nodeCount - 1
+    std::vector<int> Ap, Ai;           // full symmetric pattern of Y (CSC)
+    std::vector<int> diagSlot;         // Ax index of Y[i][i]
+    std::vector<int> gminSlots;        // diagonals of nodes floating w.r.t. ground
+    std::vector<int> elemSlots;        // 4 Ax indices per element (aa, bb, ab, ba), -1 at ground
+    std::vector<int> P, Pinv;          // fill-reducing permutation
+    std::vector<int> Lp, Parent, Lnz;  // column pointers / etree / counts of L
+};
+
+// per-frequency numeric storage; one per thread when solving in parallel
+struct MnaWorkspace {
+    std::vector<cd> Ax;
+    std::vector<cd> y;                 // element admittances at the current frequency
+    std::vector<int> Li;
+    std::vector<cd> Lx, D, Y, X;
+    std::vector<int> Lnz, Pattern, Flag;
+};
+
+// conductance from floating nodes to ground (SPICE's gmin) so they do not
+// make Y singular; 1e-10 S matches the 1e10 Ohm used for open circuits
+const double MNA_GMIN = 1e-10;
+
+void AddNetElement(Network& net, ComponentType type, double value, int nodeA, int nodeB);
+
+// the GUI's two lists as one network: the series chain runs from node 1,
+// then the parallel bank closes to ground, so Zin = Zseries + Zparallel
+void BuildNetworkFromCircuits(Network& net);
+
+// the reverse, for importers: elements with a grounded terminal go to the
+// parallel list, the rest to the series list. Replaces the circuit without
+// journaling; exact for networks of the shape built above.
+void LoadCircuitsFromNetwork(const Network& net);
+// true when net has that shape (a simple series path from inputNode whose
+// far end is the only node the grounded elements touch), so the lists'
+// series + parallel figures are its real input impedance
+bool IsSeriesParallelNetwork(const Network& net);
+
+bool AnalyzeNetwork(const Network& net, MnaSymbolic& sym);
+void PrepareWorkspace(const MnaSymbolic& sym, MnaWorkspace& ws);
+
+// admittance of every element at one frequency: 1/R, 1/(jwL), jwC
+void EvalElementAdmittances(const Network& net, double freqHz, cd* y);
+
+// Y from per-element admittances y[k] (plus gmin) into ws.Ax
+void AssembleNodalMatrix(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws, const cd* y);
+// numeric L D L^T of the assembled Y; false if it is singular
+bool FactorNodalMatrix(const MnaSymbolic& sym, MnaWorkspace& ws);
+// x = Y^-1 x with the last factorization; x is in elimination order
+// (entry Pinv[node - 1] belongs to node)
+void SolveFactored(const MnaSymbolic& sym, const MnaWorkspace& ws, cd* x);
+
+// numeric factorization + solve at one frequency; false if Y is singular
+bool SolveInputImpedance(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws,
+    double freqHz, cd& zIn);
+
+// Zin over a sweep, frequency points spread over `threads` workers
+// (work-stealing, one MnaWorkspace per worker, lock-free result writes)
+bool RunNetworkSweep(const Network& net, const SweepSettings& settings, int threads, std::vector<cd>& zOut);
+
+// same, streamed as CSV (freq_hz,zin_mag_ohm,zin_phase_deg)
+bool WriteNetworkSweepCsv(FILE* out, const Network& net, const SweepSettings& settings, int threads);
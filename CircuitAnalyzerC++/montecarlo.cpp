@@ -0,0 +1,367 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - Monte Carlo tolerance analysis
+ ********************************************************************/
+
+#include "montecarlo.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+
+// samples per chunk: the unit of work, of scratch and of the ordered merge
+const int MC_CHUNK = 4096;
+
+bool MonteCarloSettingsValid(const MonteCarloSettings& s) {
+    return s.samples >= 1 && s.samples <= MC_MAX_SAMPLES && s.freqHz > 0.0 &&
+        s.yieldBand >= 0.0 && s.bins >= 1 && s.bins <= 10000;
+}
+
+// ---------------------- Random Numbers -------------------------
+
+// SplitMix64 finalizer: a bijective 64-bit mix
+static inline uint64_t Mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+const uint64_t MC_GOLDEN = 0x9E3779B97F4A7C15ULL;
+
+static inline uint64_t StreamKey(uint64_t seed, uint64_t stream) {
+    return Mix64(seed ^ Mix64(stream + MC_GOLDEN));
+}
+
+// SplitMix64 output number `counter` of the sequence started at `key`
+static inline double UniformAt(uint64_t key, uint64_t counter) {
+    return ((double)(Mix64(key + counter * MC_GOLDEN) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double MonteCarloUniform(uint64_t seed, uint64_t stream, uint64_t counter) {
+    return UniformAt(StreamKey(seed, stream), counter);
+}
+
+// redraws of a Gaussian sample start at counter index + attempt * stride;
+// 64 misses in a row (p = 0.0027^64) fall back to the nominal value
+const uint64_t MC_REDRAW_STRIDE = 1ULL << 40;
+const int MC_MAX_REDRAWS = 64;
+
+// one component that varies; `stream` is its id, so its draws do not
+// change when other parts are added or removed
+struct TolerancedPart {
+    uint64_t stream;
+    double value;
+    double tolerance;
+};
+
+// value multipliers of samples [first, first + m)
+static void DrawFactors(const TolerancedPart& p, const MonteCarloSettings& s, long long first, int m, double* f) {
+    if (s.distribution == ToleranceDistribution::UNIFORM) {
+        uint64_t key = StreamKey(s.seed, 2 * p.stream);
+        for (int i = 0; i < m; ++i) f[i] = 1.0 + p.tolerance * (2.0 * UniformAt(key, first + i) - 1.0);
+        return;
+    }
+    // Box-Muller from two streams, truncated at 3 sigma = tolerance: a draw
+    // beyond it (0.27 %) is redrawn from counters past any sample index, so
+    // the result still depends only on (seed, part, sample)
+    uint64_t k1 = StreamKey(s.seed, 2 * p.stream), k2 = StreamKey(s.seed, 2 * p.stream + 1);
+    for (int i = 0; i < m; ++i) {
+        double z = 0.0;
+        for (int attempt = 0; attempt < MC_MAX_REDRAWS; ++attempt) {
+            uint64_t counter = (uint64_t)(first + i) + (uint64_t)attempt * MC_REDRAW_STRIDE;
+            double t = std::sqrt(-2.0 * std::log(UniformAt(k1, counter))) * std::cos(2.0 * M_PI * UniformAt(k2, counter));
+            if (std::fabs(t) <= 3.0) {
+                z = t;
+                break;
+            }
+        }
+        f[i] = 1.0 + p.tolerance * z / 3.0;
+    }
+}
+
+// ---------------------- Sampling Engine -------------------------
+
+// fills mag[q][0..m) with quantity q of samples [first, first + m)
+typedef std::function<void(long long first, int m, int worker, double* const* mag)> SampleChunkFn;
+
+struct ChunkSums {
+    double sum = 0.0;          // of |Z| - nominal, better conditioned than |Z|
+    double sumSq = 0.0;
+    double min = INFINITY, max = -INFINITY;
+    long long valid = 0, pass = 0;
+};
+
+// false if settings.progress cancelled the run
+static bool SampleInto(const MonteCarloSettings& s, int quantities, const SampleChunkFn& eval,
+    MonteCarloHistogram* const* out) {
+    int threads = std::max(1, s.threads);
+    std::vector<std::vector<double> > scratch((size_t)threads * quantities, std::vector<double>(MC_CHUNK));
+    auto buffers = [&](int worker, double** mag) {
+        for (int q = 0; q < quantities; ++q) mag[q] = scratch[(size_t)worker * quantities + q].data();
+    };
+    double* mag[3];
+
+    // bin range from a pilot chunk (the first samples, so it is reproducible too)
+    int pilot = (int)std::min<long long>(s.samples, MC_CHUNK);
+    buffers(0, mag);
+    eval(0, pilot, 0, mag);
+    for (int q = 0; q < quantities; ++q) {
+        MonteCarloHistogram& h = *out[q];
+        double lo = INFINITY, hi = -INFINITY;
+        for (int i = 0; i < pilot; ++i) {
+            if (std::isfinite(mag[q][i])) { lo = std::min(lo, mag[q][i]); hi = std::max(hi, mag[q][i]); }
+        }
+        if (!(lo <= hi)) lo = hi = h.nominal;
+        double pad = (hi > lo) ? 0.05 * (hi - lo) : 0.01 * std::max(std::fabs(lo), 1e-12);
+        h.lo = lo - pad;
+        h.hi = hi + pad;
+        h.counts.assign(s.bins, 0);
+    }
+
+    int chunks = (int)((s.samples + MC_CHUNK - 1) / MC_CHUNK);
+    std::vector<ChunkSums> sums((size_t)chunks * quantities);
+    // bins + under + over per worker and quantity; integer counts merge exactly
+    int width = s.bins + 2;
+    std::vector<long long> bins((size_t)threads * quantities * width, 0);
+    std::atomic<long long> done(0);
+    std::atomic<bool> cancelled(false);
+
+    ParallelFor(chunks, threads, 1, [&](int begin, int end, int worker) {
+        double* m[3];
+        buffers(worker, m);
+        for (int c = begin; c < end; ++c) {
+            if (cancelled.load(std::memory_order_relaxed)) return;
+            long long first = (long long)c * MC_CHUNK;
+            int count = (int)std::min<long long>(MC_CHUNK, s.samples - first);
+            eval(first, count, worker, m);
+            for (int q = 0; q < quantities; ++q) {
+                const MonteCarloHistogram& h = *out[q];
+                ChunkSums& cs = sums[(size_t)c * quantities + q];
+                long long* hist = &bins[((size_t)worker * quantities + q) * width];
+                double scale = s.bins / (h.hi - h.lo);
+                double band = s.yieldBand * std::fabs(h.nominal);
+                for (int i = 0; i < count; ++i) {
+                    double x = m[q][i];
+                    if (!std::isfinite(x)) continue;
+                    double d = x - h.nominal;
+                    cs.sum += d;
+                    cs.sumSq += d * d;
+                    cs.min = std::min(cs.min, x);
+                    cs.max = std::max(cs.max, x);
+                    cs.valid++;
+                    if (std::fabs(d) <= band) cs.pass++;
+                    if (x < h.lo) hist[s.bins]++;
+                    else if (x >= h.hi) hist[s.bins + 1]++;
+                    else hist[std::min(s.bins - 1, (int)((x - h.lo) * scale))]++;
+                }
+            }
+            if (s.progress && !s.progress(done.fetch_add(count, std::memory_order_relaxed) + count)) {
+                cancelled.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    if (cancelled.load()) return false;
+
+    for (int q = 0; q < quantities; ++q) {
+        MonteCarloHistogram& h = *out[q];
+        ChunkSums total;
+        for (int c = 0; c < chunks; ++c) {   // in chunk order: same rounding for any thread count
+            const ChunkSums& cs = sums[(size_t)c * quantities + q];
+            total.sum += cs.sum;
+            total.sumSq += cs.sumSq;
+            total.min = std::min(total.min, cs.min);
+            total.max = std::max(total.max, cs.max);
+            total.valid += cs.valid;
+            total.pass += cs.pass;
+        }
+        for (int w = 0; w < threads; ++w) {
+            const long long* hist = &bins[((size_t)w * quantities + q) * width];
+            for (int b = 0; b < s.bins; ++b) h.counts[b] += hist[b];
+            h.under += hist[s.bins];
+            h.over += hist[s.bins + 1];
+        }
+        h.invalid = s.samples - total.valid;
+        h.pass = total.pass;
+        if (total.valid > 0) {
+            double meanD = total.sum / total.valid;
+            h.mean = h.nominal + meanD;
+            h.stddev = std::sqrt(std::max(0.0, total.sumSq / total.valid - meanD * meanD));
+            h.min = total.min;
+            h.max = total.max;
+        }
+    }
+    return true;
+}
+
+// ---------------------- Series / Parallel -------------------------
+
+bool RunMonteCarlo(const MonteCarloSettings& settings, MonteCarloResult& result) {
+    return RunMonteCarlo(componentsData, settings, result);
+}
+
+bool RunMonteCarlo(const ComponentStore& components, const MonteCarloSettings& settings, MonteCarloResult& result) {
+    result = MonteCarloResult();
+    if (!MonteCarloSettingsValid(settings)) return false;
+    const int R = (int)ComponentType::RESISTOR, L = (int)ComponentType::INDUCTOR, C = (int)ComponentType::CAPACITOR;
+
+    // fixed parts become the base sums; the rest are sampled into one of six
+    // accumulators: series R, L, 1/C and parallel 1/R, 1/L, C
+    CircuitSums seriesBase, parallelBase;
+    std::vector<TolerancedPart> parts[6];
+    bool hasSeries = false, hasParallel = false;
+    for (const Component& c : components) {
+        bool series = c.circuitType == CircuitType::SERIES;
+        (series ? hasSeries : hasParallel) = true;
+        int t = (int)c.type;
+        if (c.tolerance <= 0.0 || c.value == 0.0) {
+            CircuitSums& s = series ? seriesBase : parallelBase;
+            s.count[t]++;
+            if (c.value == 0.0) s.zeros[t]++;
+            else { s.sum[t] += c.value; s.inv[t] += 1.0 / c.value; }
+            continue;
+        }
+        parts[(series ? 0 : 3) + t].push_back(TolerancedPart{ (uint64_t)c.id, c.value, c.tolerance });
+        result.toleranced++;
+    }
+
+    // the same formulas as EvalSeriesBlock / EvalParallelBlock
+    const double omega = 2.0 * M_PI * settings.freqHz;
+    const double r0 = seriesBase.sum[R] + 1e10 * seriesBase.zeros[C];
+    const double l0 = seriesBase.sum[L], cInv0 = seriesBase.inv[C];
+    const double g0 = parallelBase.inv[R] + 1e-10 * parallelBase.zeros[C];
+    const double c0 = parallelBase.sum[C], lInv0 = parallelBase.inv[L];
+    // accumulator (series 0-2, parallel 3-5) indexed by type R, C, L: the
+    // series C and parallel R and L accumulators add reciprocals
+    const bool reciprocal[6] = { false, true, false, true, false, true };
+
+    int threads = std::max(1, settings.threads);
+    // per worker: 6 accumulators + 1 factor row, MC_CHUNK each
+    std::vector<std::vector<double> > work((size_t)threads * 7, std::vector<double>(MC_CHUNK));
+
+    SampleChunkFn eval = [&](long long first, int m, int worker, double* const* mag) {
+        double* acc[6];
+        for (int a = 0; a < 6; ++a) {
+            acc[a] = work[(size_t)worker * 7 + a].data();
+            std::fill(acc[a], acc[a] + m, 0.0);
+        }
+        double* f = work[(size_t)worker * 7 + 6].data();
+        for (int a = 0; a < 6; ++a) {
+            double* dst = acc[a];
+            for (const TolerancedPart& p : parts[a]) {
+                DrawFactors(p, settings, first, m, f);
+                if (reciprocal[a]) for (int i = 0; i < m; ++i) dst[i] += 1.0 / (p.value * f[i]);
+                else for (int i = 0; i < m; ++i) dst[i] += p.value * f[i];
+            }
+        }
+        const double* sR = acc[R]; const double* sL = acc[L]; const double* sCi = acc[C];
+        const double* pG = acc[3 + R]; const double* pLi = acc[3 + L]; const double* pC = acc[3 + C];
+        for (int i = 0; i < m; ++i) {
+            double zsRe = 0.0, zsIm = 0.0, zpRe = 0.0, zpIm = 0.0;
+            if (hasSeries) {
+                zsRe = r0 + sR[i];
+                zsIm = omega * (l0 + sL[i]) - (cInv0 + sCi[i]) / omega;
+            }
+            if (hasParallel) {
+                double g = g0 + pG[i];
+                double b = omega * (c0 + pC[i]) - (lInv0 + pLi[i]) / omega;
+                double d = g * g + b * b;
+                double k = (d != 0.0) ? 1.0 / d : 0.0;
+                zpRe = g * k;
+                zpIm = -b * k;
+            }
+            mag[0][i] = std::sqrt(zsRe * zsRe + zsIm * zsIm);
+            mag[1][i] = std::sqrt(zpRe * zpRe + zpIm * zpIm);
+            mag[2][i] = std::sqrt((zsRe + zpRe) * (zsRe + zpRe) + (zsIm + zpIm) * (zsIm + zpIm));
+        }
+    };
+
+    // nominal: every factor 1, i.e. the plain analysis at this frequency
+    CircuitSums sNom = seriesBase, pNom = parallelBase;
+    for (int a = 0; a < 6; ++a) {
+        CircuitSums& s = a < 3 ? sNom : pNom;
+        for (const TolerancedPart& p : parts[a]) {
+            s.count[a % 3]++;
+            s.sum[a % 3] += p.value;
+            s.inv[a % 3] += 1.0 / p.value;
+        }
+    }
+    cd zs = hasSeries ? CalcSeriesImpedanceComplex(sNom, settings.freqHz) : cd(0.0, 0.0);
+    cd zp = hasParallel ? CalcParallelImpedanceComplex(pNom, settings.freqHz) : cd(0.0, 0.0);
+    result.series.nominal = std::abs(zs);
+    result.parallel.nominal = std::abs(zp);
+    result.combined.nominal = std::abs(zs + zp);
+
+    MonteCarloHistogram* out[3] = { &result.series, &result.parallel, &result.combined };
+    if (!SampleInto(settings, 3, eval, out)) return false;
+    result.samples = settings.samples;
+    return true;
+}
+
+// ---------------------- Network -------------------------
+
+bool RunNetworkMonteCarlo(const Network& net, const MonteCarloSettings& settings, MonteCarloHistogram& result) {
+    result = MonteCarloHistogram();
+    if (!MonteCarloSettingsValid(settings)) return false;
+    MnaSymbolic sym;
+    if (!AnalyzeNetwork(net, sym)) return false;
+    MnaWorkspace nominalWs;
+    cd z;
+    if (!SolveInputImpedance(net, sym, nominalWs, settings.freqHz, z)) return false;
+    result.nominal = std::abs(z);
+
+    int threads = std::max(1, settings.threads);
+    std::vector<TolerancedPart> parts;
+    std::vector<int> partElement;
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        const Component& c = net.elements[k].comp;
+        if (c.tolerance <= 0.0 || c.value == 0.0) continue;
+        parts.push_back(TolerancedPart{ (uint64_t)c.id, c.value, c.tolerance });
+        partElement.push_back((int)k);
+    }
+
+    // per worker: a network copy whose values are overwritten per sample,
+    // a workspace and one factor row per toleranced part
+    std::vector<Network> nets(threads, net);
+    std::vector<MnaWorkspace> workspaces(threads);
+    std::vector<std::vector<double> > factors((size_t)threads * parts.size(), std::vector<double>(MC_CHUNK));
+
+    SampleChunkFn eval = [&](long long first, int m, int worker, double* const* mag) {
+        Network& wn = nets[worker];
+        for (size_t j = 0; j < parts.size(); ++j) {
+            DrawFactors(parts[j], settings, first, m, factors[(size_t)worker * parts.size() + j].data());
+        }
+        for (int i = 0; i < m; ++i) {
+            for (size_t j = 0; j < parts.size(); ++j) {
+                wn.elements[partElement[j]].comp.value = parts[j].value * factors[(size_t)worker * parts.size() + j][i];
+            }
+            cd zi;
+            bool ok = SolveInputImpedance(wn, sym, workspaces[worker], settings.freqHz, zi);
+            mag[0][i] = ok ? std::abs(zi) : NAN;
+        }
+    };
+
+    MonteCarloHistogram* out[1] = { &result };
+    return SampleInto(settings, 1, eval, out);
+}
+
+// ---------------------- Report -------------------------
+
+double MonteCarloYield(const MonteCarloHistogram& h, long long samples) {
+    return samples > 0 ? (double)h.pass / (double)samples : 0.0;
+}
+
+void PrintMonteCarloHistogram(FILE* out, const char* title, const MonteCarloHistogram& h, long long samples) {
+    fprintf(out, "%s: nominal %.4g Ohm | mean %.4g | std %.4g | min %.4g | max %.4g | yield %.2f%%\n",
+        title, h.nominal, h.mean, h.stddev, h.min, h.max, 100.0 * MonteCarloYield(h, samples));
+    long long peak = 1;
+    for (long long c : h.counts) peak = std::max(peak, c);
+    double width = (h.hi - h.lo) / std::max<size_t>(1, h.counts.size());
+    for (size_t b = 0; b < h.counts.size(); ++b) {
+        int bar = (int)(50 * h.counts[b] / peak);
+        fprintf(out, "  %12.5g | %-50.*s %lld\n", h.lo + (b + 0.5) * width, bar,
+            "##################################################", h.counts[b]);
+    }
+    if (h.under + h.over + h.invalid > 0) {
+        fprintf(out, "  below %lld, above %lld, singular %lld\n", h.under, h.over, h.invalid);
+    }
+}
@@ -0,0 +1,79 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - Monte Carlo tolerance analysis
+ *
+ * Each sample draws every toleranced component (Component::tolerance)
+ * from a counter-based generator: the random number is a hash of
+ * (seed, component id, sample index), so no generator state is shared
+ * and a sample's values do not depend on which thread draws them.
+ * Samples are evaluated in fixed chunks whose partial sums are merged
+ * in chunk order, so the results are identical for any thread count.
+ *
+ * The series/parallel circuits reduce to per-type sums: parts without
+ * a tolerance are folded into constants once, the rest are accumulated
+ * over a chunk of samples in plain arrays so the loops vectorize. A
+ * Network is solved by nodal analysis per sample (symbolic part shared).
+ ********************************************************************/
+
+#pragma once
+
+#include "mna.h"
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// UNIFORM: flat over value * (1 +- tolerance). GAUSSIAN: tolerance is
+// 3 sigma, truncated there (draws beyond it are redrawn, not clipped).
+enum class ToleranceDistribution { UNIFORM = 0, GAUSSIAN = 1 };
+
+struct MonteCarloSettings {
+    long long samples = 100000;
+    uint64_t seed = 1;
+    ToleranceDistribution distribution = ToleranceDistribution::UNIFORM;
+    double freqHz = 50.0;
+    double yieldBand = 0.05;   // a sample passes if |Z| is within +-5 % of nominal
+    int bins = 40;
+    int threads = 1;
+    // optional: called after every chunk with the samples finished so far,
+    // from whichever sampling thread ran it; returning false cancels the run
+    std::function<bool(long long done)> progress;
+};
+
+// distribution of one |Z| (Ohm) over all samples
+struct MonteCarloHistogram {
+    double nominal = 0.0;      // every part at its nominal value
+    double lo = 0.0, hi = 0.0; // bin range, from a pilot chunk
+    std::vector<long long> counts;
+    long long under = 0, over = 0;
+    long long invalid = 0;     // singular samples (networks only)
+    long long pass = 0;        // samples inside the yield band
+    double mean = 0.0, stddev = 0.0, min = 0.0, max = 0.0;
+};
+
+struct MonteCarloResult {
+    long long samples = 0;
+    int toleranced = 0;        // components that actually vary
+    MonteCarloHistogram series, parallel, combined;
+};
+
+// the per-chunk partial sums kept for the ordered merge grow with this
+const long long MC_MAX_SAMPLES = 1000000000LL;
+
+bool MonteCarloSettingsValid(const MonteCarloSettings& s);
+
+// uniform in (0, 1) for sample `counter` of stream `stream`
+double MonteCarloUniform(uint64_t seed, uint64_t stream, uint64_t counter);
+
+// the current series and parallel circuits; false if cancelled
+bool RunMonteCarlo(const MonteCarloSettings& settings, MonteCarloResult& result);
+// the same for a snapshot of componentsData
+bool RunMonteCarlo(const ComponentStore& components, const MonteCarloSettings& settings, MonteCarloResult& result);
+// input impedance of a network; false if it is singular at nominal values
+// or cancelled
+bool RunNetworkMonteCarlo(const Network& net, const MonteCarloSettings& settings, MonteCarloHistogram& result);
+
+// yield in [0, 1]
+double MonteCarloYield(const MonteCarloHistogram& h, long long samples);
+
+// statistics plus a text histogram
+void PrintMonteCarloHistogram(FILE* out, const char* title, const MonteCarloHistogram& h, long long samples);
@@ -0,0 +1,168 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - work-stealing parallel loop
+ ********************************************************************/
+
+#include "parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// (begin << 32) | end, padded to its own cache line
+struct alignas(64) WorkRange {
+    std::atomic<uint64_t> range;
+};
+
+uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+bool PopChunk(WorkRange& r, int grain, int& begin, int& end) {
+    uint64_t cur = r.range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)(cur >> 32), e = (uint32_t)cur;
+        if (b >= e) return false;
+        uint32_t nb = (e - b > (uint32_t)grain) ? b + grain : e;
+        if (r.range.compare_exchange_weak(cur, PackRange(nb, e), std::memory_order_acq_rel)) {
+            begin = (int)b;
+            end = (int)nb;
+            return true;
+        }
+    }
+}
+
+// takes the back half of the victim's remaining range
+bool StealHalf(WorkRange& victim, int grain, int& begin, int& end) {
+    uint64_t cur = victim.range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)(cur >> 32), e = (uint32_t)cur;
+        if (b >= e || e - b <= (uint32_t)grain) return false;   // not worth splitting
+        uint32_t mid = b + (e - b) / 2;
+        if (victim.range.compare_exchange_weak(cur, PackRange(b, mid), std::memory_order_acq_rel)) {
+            begin = (int)mid;
+            end = (int)e;
+            return true;
+        }
+    }
+}
+
+// ---------------------- Resident Workers -------------------------
+
+struct WorkerPool {
+    std::atomic<bool> owned{ false };   // a loop is using the helpers
+    std::mutex lock;                    // guards everything below
+    std::condition_variable wake, done;
+    std::vector<std::thread> helpers;   // helper k runs as worker k + 1
+    const std::function<void(int)>* job = nullptr;
+    int jobHelpers = 0;                 // helpers taking part in the current job
+    int pending = 0;                    // of those, still running it
+    uint64_t generation = 0;            // bumped per job
+    bool quit = false;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : helpers) t.join();
+    }
+};
+
+WorkerPool workerPool;
+
+static void HelperLoop(int k) {
+    WorkerPool& p = workerPool;
+    uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(int)>* job;
+        {
+            std::unique_lock<std::mutex> guard(p.lock);
+            p.wake.wait(guard, [&] { return p.quit || (p.generation != seen && k < p.jobHelpers); });
+            if (p.quit) return;
+            seen = p.generation;
+            job = p.job;
+        }
+        (*job)(k + 1);
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (--p.pending == 0) p.done.notify_one();
+    }
+}
+
+// job(0) on the caller and job(1..helpers) on resident threads; the
+// caller has set workerPool.owned
+static void RunOnHelpers(int helpers, const std::function<void(int)>& job) {
+    WorkerPool& p = workerPool;
+    while ((int)p.helpers.size() < helpers) p.helpers.emplace_back(HelperLoop, (int)p.helpers.size());
+    {
+        std::lock_guard<std::mutex> guard(p.lock);
+        p.job = &job;
+        p.jobHelpers = helpers;
+        p.pending = helpers;
+        p.generation++;
+    }
+    p.wake.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> guard(p.lock);
+    p.done.wait(guard, [&] { return p.pending == 0; });
+    p.job = nullptr;
+}
+
+// ---------------------- Parallel Loop -------------------------
+
+int HardwareThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : (int)n;
+}
+
+void ParallelFor(int count, int threads, int grain,
+    const std::function<void(int begin, int end, int worker)>& body) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    if (threads < 1) threads = 1;
+    if (threads > count / grain) threads = count / grain > 0 ? count / grain : 1;
+    if (threads == 1) {
+        body(0, count, 0);
+        return;
+    }
+
+    std::vector<WorkRange> ranges(threads);
+    for (int w = 0; w < threads; ++w) {
+        uint32_t b = (uint32_t)((int64_t)count * w / threads);
+        uint32_t e = (uint32_t)((int64_t)count * (w + 1) / threads);
+        ranges[w].range.store(PackRange(b, e), std::memory_order_relaxed);
+    }
+
+    std::function<void(int)> worker = [&](int id) {
+        int begin, end;
+        for (;;) {
+            while (PopChunk(ranges[id], grain, begin, end)) body(begin, end, id);
+
+            bool stole = false;
+            for (int k = 1; k < threads && !stole; ++k) {
+                int victim = (id + k) % threads;
+                if (StealHalf(ranges[victim], grain, begin, end)) {
+                    // own range is empty, so only thieves can race with this store
+                    ranges[id].range.store(PackRange((uint32_t)begin, (uint32_t)end), std::memory_order_release);
+                    stole = true;
+                }
+            }
+            if (!stole) return;
+        }
+    };
+
+    // a flag, not a mutex: a nested call on the owning thread must not lock twice
+    bool expected = false;
+    if (workerPool.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        RunOnHelpers(threads - 1, worker);
+        workerPool.owned.store(false, std::memory_order_release);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (int w = 1; w < threads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+}
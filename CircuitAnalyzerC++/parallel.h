@@ -0,0 +1,26 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - work-stealing parallel loop
+ *
+ * ParallelFor splits [0, count) into one contiguous range per worker.
+ * Each range is a single atomic (begin, end) pair: the owner takes
+ * grain-sized chunks off the front and an idle worker steals the back
+ * half of a busy one, both with one compare-and-swap, so no locks are
+ * taken while work is handed out.
+ *
+ * The helper threads are resident: started on first use, then asleep
+ * between loops, so a call costs a wake-up rather than thread starts.
+ * One loop owns them at a time; a loop started while they are busy (from
+ * another thread, or nested in a body) runs on short-lived threads.
+ ********************************************************************/
+
+#pragma once
+
+#include <functional>
+
+int HardwareThreads();
+
+// body(begin, end, worker) is called for disjoint chunks covering
+// [0, count); worker is 0..threads-1 and can index per-thread scratch.
+// The calling thread is worker 0.
+void ParallelFor(int count, int threads, int grain,
+    const std::function<void(int begin, int end, int worker)>& body);
@@ -0,0 +1,71 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - pooled block allocator
+ ********************************************************************/
+
+#include "pool.h"
+#include <atomic>
+#include <mutex>
+
+const size_t POOL_GRANULE = 16;
+const size_t POOL_CHUNK = 64 * 1024;
+const int POOL_CLASSES = (int)(POOL_MAX_BLOCK / POOL_GRANULE);
+
+struct PoolBlock {
+    PoolBlock* next;
+};
+
+struct BlockPool {
+    std::mutex lock;
+    PoolBlock* freeList = nullptr;
+    char* bump = nullptr;      // unused tail of the newest chunk
+    char* bumpEnd = nullptr;
+};
+
+BlockPool blockPools[POOL_CLASSES];
+std::atomic<long long> poolChunks(0);
+
+static int SizeClass(size_t bytes) {
+    return (int)((bytes + POOL_GRANULE - 1) / POOL_GRANULE) - 1;
+}
+
+void* PoolAllocate(size_t bytes) {
+    if (bytes == 0) bytes = 1;
+    if (bytes > POOL_MAX_BLOCK) return ::operator new(bytes);
+    int c = SizeClass(bytes);
+    size_t block = (size_t)(c + 1) * POOL_GRANULE;
+    BlockPool& pool = blockPools[c];
+
+    std::lock_guard<std::mutex> guard(pool.lock);
+    if (pool.freeList) {
+        PoolBlock* b = pool.freeList;
+        pool.freeList = b->next;
+        return b;
+    }
+    if (pool.bump == nullptr || (size_t)(pool.bumpEnd - pool.bump) < block) {
+        // the leftover tail of the old chunk is simply abandoned
+        pool.bump = static_cast<char*>(::operator new(POOL_CHUNK));
+        pool.bumpEnd = pool.bump + POOL_CHUNK;
+        poolChunks.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = pool.bump;
+    pool.bump += block;
+    return p;
+}
+
+void PoolFree(void* p, size_t bytes) {
+    if (!p) return;
+    if (bytes == 0) bytes = 1;
+    if (bytes > POOL_MAX_BLOCK) {
+        ::operator delete(p);
+        return;
+    }
+    BlockPool& pool = blockPools[SizeClass(bytes)];
+    std::lock_guard<std::mutex> guard(pool.lock);
+    PoolBlock* b = static_cast<PoolBlock*>(p);
+    b->next = pool.freeList;
+    pool.freeList = b;
+}
+
+long long PoolChunkCount() {
+    return poolChunks.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,39 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - pooled block allocator
+ *
+ * Fixed-size blocks carved from 64 KB chunks, one pool per 16-byte size
+ * class up to POOL_MAX_BLOCK. Freed blocks go on the pool's free list and
+ * are handed out again, so once a working set has been reached allocate
+ * and free never call malloc. Chunks are kept for reuse, not returned.
+ * Each pool takes a small lock: the component store's nodes can be
+ * released on the analysis worker thread.
+ ********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+const size_t POOL_MAX_BLOCK = 4096;
+
+// falls back to operator new above POOL_MAX_BLOCK
+void* PoolAllocate(size_t bytes);
+void PoolFree(void* p, size_t bytes);
+
+// chunks obtained from the heap so far (all pools)
+long long PoolChunkCount();
+
+// std allocator on top of the pools, for containers and allocate_shared
+template <typename T>
+struct PoolAllocator {
+    typedef T value_type;
+
+    PoolAllocator() noexcept {}
+    template <typename U> PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(PoolAllocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) noexcept { PoolFree(p, n * sizeof(T)); }
+
+    template <typename U> bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
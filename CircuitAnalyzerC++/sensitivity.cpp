@@ -0,0 +1,100 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - impedance sensitivities
+ ********************************************************************/
+
+#include "sensitivity.h"
+#include <algorithm>
+#include <cmath>
+
+static void FinishEntries(cd z, std::vector<SensitivityEntry>& out) {
+    double mag = std::abs(z);
+    for (SensitivityEntry& e : out) {
+        // d|Z| = Re(conj(Z) dZ) / |Z|
+        e.dMag = mag > 0.0 ? (std::conj(z) * e.dZ).real() / mag : 0.0;
+        e.relative = mag > 0.0 ? e.value * e.dMag / mag : 0.0;
+    }
+    std::stable_sort(out.begin(), out.end(), [](const SensitivityEntry& a, const SensitivityEntry& b) {
+        return std::fabs(a.relative) > std::fabs(b.relative);
+    });
+}
+
+// ---------------------- Series / Parallel -------------------------
+
+double CircuitSensitivities(double freqHz, std::vector<SensitivityEntry>& out) {
+    return CircuitSensitivities(componentsData, freqHz, out);
+}
+
+double CircuitSensitivities(const ComponentStore& components, double freqHz, std::vector<SensitivityEntry>& out) {
+    out.clear();
+    double omega = 2.0 * M_PI * freqHz;
+    CircuitSums series = SumComponents(components, CircuitType::SERIES);
+    CircuitSums parallel = SumComponents(components, CircuitType::PARALLEL);
+    auto empty = [](const CircuitSums& s) { return s.count[0] + s.count[1] + s.count[2] == 0; };
+    cd zs = empty(series) ? cd(0.0, 0.0) : CalcSeriesImpedanceComplex(series, freqHz);
+    cd zp = empty(parallel) ? cd(0.0, 0.0) : CalcParallelImpedanceComplex(parallel, freqHz);
+
+    out.reserve(components.size());
+    for (const Component& c : components) {
+        cd dZ(0.0, 0.0);
+        double v = c.value;
+        if (c.circuitType == CircuitType::SERIES) {
+            switch (c.type) {
+            case ComponentType::RESISTOR: dZ = 1.0; break;
+            case ComponentType::INDUCTOR: dZ = J * omega; break;
+            case ComponentType::CAPACITOR: if (v != 0.0) dZ = J / (omega * v * v); break;   // d(-j/(wC))
+            }
+        }
+        else {
+            cd dY(0.0, 0.0);
+            switch (c.type) {
+            case ComponentType::RESISTOR: if (v != 0.0) dY = -1.0 / (v * v); break;
+            case ComponentType::INDUCTOR: if (v != 0.0 && omega != 0.0) dY = J / (omega * v * v); break;   // d(-j/(wL))
+            case ComponentType::CAPACITOR: dY = J * omega; break;
+            }
+            dZ = -zp * zp * dY;
+        }
+        out.push_back(SensitivityEntry{ c.id, c.type, v, dZ, 0.0, 0.0 });
+    }
+    FinishEntries(zs + zp, out);
+    return std::abs(zs + zp);
+}
+
+// ---------------------- Network (adjoint) -------------------------
+
+bool NetworkSensitivities(const Network& net, double freqHz, std::vector<SensitivityEntry>& out, cd& zIn) {
+    out.clear();
+    MnaSymbolic sym;
+    MnaWorkspace ws;
+    if (!AnalyzeNetwork(net, sym) || !SolveInputImpedance(net, sym, ws, freqHz, zIn)) return false;
+
+    // ws.X is x = Y^-1 e_in (elimination order), which is also the adjoint
+    // solution since Y = Y^T
+    double omega = 2.0 * M_PI * freqHz;
+    auto nodeVoltage = [&](int node) { return node > 0 ? ws.X[sym.Pinv[node - 1]] : cd(0.0, 0.0); };
+    out.reserve(net.elements.size());
+    for (const NetElement& e : net.elements) {
+        cd u = nodeVoltage(e.nodeA) - nodeVoltage(e.nodeB);
+        double v = e.comp.value;
+        cd dy(0.0, 0.0);   // d(admittance)/d(value), 0 where the model is an ideal short
+        switch (e.comp.type) {
+        case ComponentType::RESISTOR: if (v != 0.0) dy = -1.0 / (v * v); break;
+        case ComponentType::INDUCTOR: if (v != 0.0 && omega != 0.0) dy = J / (omega * v * v); break;
+        case ComponentType::CAPACITOR: dy = J * omega; break;
+        }
+        out.push_back(SensitivityEntry{ e.comp.id, e.comp.type, v, -u * u * dy, 0.0, 0.0 });
+    }
+    FinishEntries(zIn, out);
+    return true;
+}
+
+// ---------------------- Report -------------------------
+
+void PrintSensitivityTable(FILE* out, const std::vector<SensitivityEntry>& entries, int rows) {
+    fprintf(out, "rank,id,type,value,dZ_re,dZ_im,dmag_per_unit,relative\n");
+    int n = std::min(rows, (int)entries.size());
+    for (int i = 0; i < n; ++i) {
+        const SensitivityEntry& e = entries[i];
+        fprintf(out, "%d,%d,%s,%.6g,%.6g,%.6g,%.6g,%.4f\n", i + 1, e.id, TypeToString(e.type).c_str(),
+            e.value, e.dZ.real(), e.dZ.imag(), e.dMag, e.relative);
+    }
+}
@@ -0,0 +1,44 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - impedance sensitivities
+ *
+ * dZ/dvalue of every component in one pass instead of one perturbed
+ * re-solve per part.
+ *
+ * Series/parallel circuits: closed form from the same sums as
+ * CalcSeriesImpedance / CalcParallelImpedance,
+ *     Zs = sum R + jw sum L - j/w sum 1/C      dZs/dv direct
+ *     Zp = 1 / Y, Y = sum 1/R + jw sum C - j/w sum 1/L,
+ *     dZp/dv = -Zp^2 dY/dv
+ * and Z = Zs + Zp.
+ *
+ * Networks (adjoint method): Zin = e^T Y^-1 e, so dZin/dp = -x^T dY/dp x
+ * with x = Y^-1 e. Y is symmetric, so the adjoint solve is the forward
+ * one and each element costs O(1): dZin/dy_k = -(x_a - x_b)^2.
+ ********************************************************************/
+
+#pragma once
+
+#include "mna.h"
+#include <vector>
+#include <cstdio>
+
+struct SensitivityEntry {
+    int id;
+    ComponentType type;
+    double value;
+    cd dZ;                 // dZ/dvalue (Ohm per unit of value)
+    double dMag;           // d|Z|/dvalue
+    double relative;       // (value / |Z|) d|Z|/dvalue: % change of |Z| per % of value
+};
+
+// every component of the series and parallel circuits, for Z = Zs + Zp;
+// ranked by |relative|. Returns |Z|.
+double CircuitSensitivities(double freqHz, std::vector<SensitivityEntry>& out);
+// the same for a snapshot of componentsData
+double CircuitSensitivities(const ComponentStore& components, double freqHz, std::vector<SensitivityEntry>& out);
+
+// every network element for Zin, ranked; false if the network is singular
+bool NetworkSensitivities(const Network& net, double freqHz, std::vector<SensitivityEntry>& out, cd& zIn);
+
+// "rank, id, type, value, dZ/dv, relative" table of the first `rows` entries
+void PrintSensitivityTable(FILE* out, const std::vector<SensitivityEntry>& entries, int rows);
@@ -0,0 +1,259 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - binary circuit snapshots
+ ********************************************************************/
+
+#include "snapshot.h"
+#include "circuitcore.h"
+#include "mappedfile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+const char SNAPSHOT_MAGIC[8] = { 'C', 'I', 'R', 'C', 'S', 'N', 'A', 'P' };
+const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+const char* SnapshotStatusText(SnapshotStatus s) {
+    switch (s) {
+    case SnapshotStatus::OK: return "OK";
+    case SnapshotStatus::CANNOT_OPEN: return "cannot open file";
+    case SnapshotStatus::WRITE_FAILED: return "write failed";
+    case SnapshotStatus::BAD_FORMAT: return "not a circuit snapshot";
+    case SnapshotStatus::BAD_VERSION: return "unsupported snapshot version";
+    case SnapshotStatus::BAD_CHECKSUM: return "checksum mismatch (file damaged)";
+    case SnapshotStatus::BAD_TOLERANCE: return "a tolerance above 25.5 % or finer than 0.1 % cannot be saved";
+    }
+    return "unknown";
+}
+
+// records are 16 bytes, so the body is always whole 64-bit words
+static uint64_t ChecksumWords(uint64_t h, const void* data, size_t bytes) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * FNV_PRIME;
+    }
+    return h;
+}
+
+// from version 3 the checksum starts with the header, its own field zeroed
+static uint64_t HeaderChecksum(SnapshotHeader h) {
+    h.checksum = 0;
+    return ChecksumWords(FNV_OFFSET, &h, sizeof(h));
+}
+
+// the record holds 0 - 255 steps of 0.1 %; anything else would change
+// on a round trip
+static bool ToleranceFits(double tolerance) {
+    double steps = std::round(tolerance * 1000.0);
+    return steps >= 0.0 && steps <= 255.0 && std::fabs(steps / 1000.0 - tolerance) <= 1e-12;
+}
+
+static bool JournalTolerancesFit() {
+    for (size_t i = 0; i < undoJournal.size(); ++i) {
+        const UndoEntry& e = undoJournal[i];
+        if (!e.batch) {
+            if (!ToleranceFits(e.comp.tolerance)) return false;
+            continue;
+        }
+        for (const Component& c : e.batch->added) if (!ToleranceFits(c.tolerance)) return false;
+        for (const Component& c : e.batch->removed) if (!ToleranceFits(c.tolerance)) return false;
+    }
+    return true;
+}
+
+static SnapshotRecord MakeRecord(const Component& c, uint8_t added) {
+    SnapshotRecord r;
+    memset(&r, 0, sizeof(r));
+    r.id = c.id;
+    r.type = (uint8_t)c.type;
+    r.circuit = (uint8_t)c.circuitType;
+    r.added = added;
+    r.tolerance = (uint8_t)std::lround(c.tolerance * 1000.0);   // ToleranceFits checked it
+    r.value = c.value;
+    return r;
+}
+
+// ---------------------- Save -------------------------
+
+// buffered record writer that checksums as it goes
+struct SnapshotWriter {
+    FILE* f = nullptr;
+    uint64_t checksum = FNV_OFFSET;
+    SnapshotRecord buf[4096];
+    int used = 0;
+    bool ok = true;
+
+    void Flush() {
+        if (used == 0) return;
+        checksum = ChecksumWords(checksum, buf, used * sizeof(SnapshotRecord));
+        if (fwrite(buf, sizeof(SnapshotRecord), used, f) != (size_t)used) ok = false;
+        used = 0;
+    }
+    void Put(const SnapshotRecord& r) {
+        buf[used++] = r;
+        if (used == 4096) Flush();
+    }
+};
+
+SnapshotStatus SaveSnapshot(const char* path) {
+    for (const Component& c : componentsData) {
+        if (!ToleranceFits(c.tolerance)) return SnapshotStatus::BAD_TOLERANCE;
+    }
+    if (!JournalTolerancesFit()) return SnapshotStatus::BAD_TOLERANCE;
+
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return SnapshotStatus::CANNOT_OPEN;
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.headerSize = sizeof(SnapshotHeader);
+    h.componentCount = componentsData.size();
+    h.journalCount = 0;
+    for (size_t i = 0; i < undoJournal.size(); ++i) {
+        const UndoEntry& e = undoJournal[i];
+        h.journalCount += e.batch ? e.batch->added.size() + e.batch->removed.size() : 1;
+    }
+    h.nextId = nextId;
+    h.analysisFreqHz = analysisFrequencyHz;
+
+    // header goes in twice: a placeholder now, the checksummed one at the end
+    SnapshotWriter w;
+    w.f = f;
+    w.checksum = HeaderChecksum(h);
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    for (const Component& c : componentsData) w.Put(MakeRecord(c, SNAPSHOT_ADDED));
+    for (size_t i = 0; i < undoJournal.size(); ++i) {
+        const UndoEntry& e = undoJournal[i];
+        if (!e.batch) {
+            w.Put(MakeRecord(e.comp, e.added ? SNAPSHOT_ADDED : 0));
+            continue;
+        }
+        // added parts, then removed ones, all but the last flagged MORE
+        size_t left = e.batch->added.size() + e.batch->removed.size();
+        for (const Component& c : e.batch->added) w.Put(MakeRecord(c, SNAPSHOT_ADDED | (--left ? SNAPSHOT_MORE : 0)));
+        for (const Component& c : e.batch->removed) w.Put(MakeRecord(c, --left ? SNAPSHOT_MORE : 0));
+    }
+    w.Flush();
+    ok = ok && w.ok;
+    h.checksum = w.checksum;
+
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        remove(tmp.c_str());
+        return SnapshotStatus::WRITE_FAILED;
+    }
+    // the old snapshot stays until the new one replaces it in one step
+    if (!ReplaceFileWith(path, tmp.c_str())) {
+        remove(tmp.c_str());
+        return SnapshotStatus::WRITE_FAILED;
+    }
+    return SnapshotStatus::OK;
+}
+
+// ---------------------- Open -------------------------
+
+static bool RecordValid(const SnapshotRecord& r) {
+    return r.id > 0 && r.id <= MAX_COMPONENT_ID && r.type <= 2 && r.circuit <= 1 && r.added <= (SNAPSHOT_ADDED | SNAPSHOT_MORE);
+}
+
+static Component RecordComponent(const SnapshotRecord& r) {
+    return Component(r.id, (ComponentType)r.type, r.value, (CircuitType)r.circuit, r.tolerance / 1000.0);
+}
+
+static SnapshotStatus CheckSnapshot(const MappedFile& mf, SnapshotHeader& h) {
+    if (mf.size < sizeof(SnapshotHeader)) return SnapshotStatus::BAD_FORMAT;
+    memcpy(&h, mf.data, sizeof(h));
+    if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) return SnapshotStatus::BAD_FORMAT;
+    if (h.version < 1 || h.version > SNAPSHOT_VERSION || h.headerSize != sizeof(SnapshotHeader)) {
+        return SnapshotStatus::BAD_VERSION;
+    }
+
+    // sizes checked by division so a corrupt count cannot overflow
+    uint64_t records = (mf.size - sizeof(SnapshotHeader)) / sizeof(SnapshotRecord);
+    if ((mf.size - sizeof(SnapshotHeader)) % sizeof(SnapshotRecord) != 0 ||
+        h.componentCount > records || h.journalCount != records - h.componentCount || h.nextId < 1) {
+        return SnapshotStatus::BAD_FORMAT;
+    }
+    const char* body = mf.data + sizeof(SnapshotHeader);
+    uint64_t seed = h.version >= 3 ? HeaderChecksum(h) : FNV_OFFSET;
+    if (ChecksumWords(seed, body, mf.size - sizeof(SnapshotHeader)) != h.checksum) {
+        return SnapshotStatus::BAD_CHECKSUM;
+    }
+
+    const SnapshotRecord* rec = (const SnapshotRecord*)body;
+    int32_t lastId = 0;
+    for (uint64_t i = 0; i < h.componentCount; ++i) {
+        if (!RecordValid(rec[i]) || rec[i].id <= lastId) return SnapshotStatus::BAD_FORMAT;
+        lastId = rec[i].id;
+    }
+    if (lastId >= h.nextId) return SnapshotStatus::BAD_FORMAT;
+    // whole entries only, the last one closed, at most MAX_UNDO_STEPS of them
+    size_t entries = 0;
+    for (uint64_t i = h.componentCount; i < records; ++i) {
+        if (!RecordValid(rec[i]) || rec[i].id >= h.nextId) return SnapshotStatus::BAD_FORMAT;
+        bool more = (rec[i].added & SNAPSHOT_MORE) != 0;
+        if (more && (i + 1 == records || h.version < 2)) return SnapshotStatus::BAD_FORMAT;
+        if (!more) entries++;
+    }
+    if (entries > MAX_UNDO_STEPS) return SnapshotStatus::BAD_FORMAT;
+
+    // Undo must find what it expects: replay the journal backwards over the
+    // set of present ids (the table plus the ids toggled so far)
+    std::unordered_set<int32_t> toggled;   // ids toggled an odd number of times
+    for (uint64_t i = records; i-- > h.componentCount;) {
+        const SnapshotRecord& r = rec[i];
+        bool present = std::binary_search(rec, rec + h.componentCount, r,
+            [](const SnapshotRecord& a, const SnapshotRecord& b) { return a.id < b.id; });
+        if (toggled.count(r.id)) present = !present;
+        if (present != ((r.added & SNAPSHOT_ADDED) != 0)) return SnapshotStatus::BAD_FORMAT;
+        if (!toggled.erase(r.id)) toggled.insert(r.id);
+    }
+    return SnapshotStatus::OK;
+}
+
+SnapshotStatus OpenSnapshot(const char* path) {
+    MappedFile mf;
+    if (!MapFile(path, mf)) return SnapshotStatus::CANNOT_OPEN;
+    SnapshotHeader h;
+    SnapshotStatus status = CheckSnapshot(mf, h);
+    if (status != SnapshotStatus::OK) {
+        UnmapFile(mf);
+        return status;
+    }
+
+    // records are 8-byte aligned in the mapping (64-byte header, 16-byte
+    // records); the store is rebuilt from them, see OpenSnapshot in snapshot.h
+    const SnapshotRecord* rec = (const SnapshotRecord*)(mf.data + sizeof(SnapshotHeader));
+    ClearCircuit();
+    for (uint64_t i = 0; i < h.componentCount; ++i) RestoreComponent(RecordComponent(rec[i]));
+    std::shared_ptr<EditBatch> batch;
+    for (uint64_t i = 0; i < h.journalCount; ++i) {
+        const SnapshotRecord& r = rec[h.componentCount + i];
+        bool added = (r.added & SNAPSHOT_ADDED) != 0;
+        if (!batch && !(r.added & SNAPSHOT_MORE)) {
+            undoJournal.push_back(UndoEntry{ added, RecordComponent(r) });
+            continue;
+        }
+        if (!batch) batch = std::make_shared<EditBatch>();
+        (added ? batch->added : batch->removed).push_back(RecordComponent(r));
+        if (!(r.added & SNAPSHOT_MORE)) {
+            const Component& c = batch->added.empty() ? batch->removed.front() : batch->added.front();
+            undoJournal.push_back(UndoEntry{ !batch->added.empty(), c, batch });
+            batch.reset();
+        }
+    }
+    nextId = h.nextId;
+    if (std::isfinite(h.analysisFreqHz) && h.analysisFreqHz > 0.0) analysisFrequencyHz = h.analysisFreqHz;
+    UnmapFile(mf);
+    return SnapshotStatus::OK;
+}
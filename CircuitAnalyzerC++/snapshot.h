@@ -0,0 +1,65 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - binary circuit snapshots
+ *
+ * Layout (little-endian), fixed-size records so a mapped file is
+ * verified in place, without parsing or copying it:
+ *     SnapshotHeader                     64 bytes
+ *     SnapshotRecord[componentCount]     component table, ascending id
+ *     SnapshotRecord[journalCount]       undo journal, oldest first
+ * A bulk journal entry is a run of records, each but the last flagged
+ * SNAPSHOT_MORE. Version 1 files (no bulk entries) still open.
+ * The checksum is FNV-1a over the 64-bit words of the header (its
+ * checksum field zeroed) and then the records; in versions 1 and 2 it
+ * covered the records only, and such files still open.
+ ********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+const uint32_t SNAPSHOT_VERSION = 3;
+
+// SnapshotRecord::added bits
+const uint8_t SNAPSHOT_ADDED = 1;   // add, else remove
+const uint8_t SNAPSHOT_MORE = 2;    // the next record is part of the same entry
+
+struct SnapshotHeader {
+    char magic[8];             // "CIRCSNAP"
+    uint32_t version;
+    uint32_t headerSize;       // sizeof(SnapshotHeader)
+    uint64_t componentCount;
+    uint64_t journalCount;     // records, not entries
+    uint64_t checksum;
+    int32_t nextId;
+    int32_t reserved;
+    double analysisFreqHz;
+    uint8_t padding[8];
+};
+
+struct SnapshotRecord {
+    int32_t id;
+    uint8_t type;              // ComponentType
+    uint8_t circuit;           // CircuitType
+    uint8_t added;             // journal only: SNAPSHOT_ADDED | SNAPSHOT_MORE
+    uint8_t tolerance;         // in 0.1 % steps (0 - 25.5 %); was reserved, always 0
+    double value;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header layout");
+static_assert(sizeof(SnapshotRecord) == 16, "snapshot record layout");
+
+enum class SnapshotStatus { OK, CANNOT_OPEN, WRITE_FAILED, BAD_FORMAT, BAD_VERSION, BAD_CHECKSUM, BAD_TOLERANCE };
+
+const char* SnapshotStatusText(SnapshotStatus s);
+
+// writes the circuit and its undo journal (temp file + rename); refuses
+// with BAD_TOLERANCE, writing nothing, if a tolerance is not a whole
+// number of 0.1 % steps up to 25.5 % (what SnapshotRecord holds)
+SnapshotStatus SaveSnapshot(const char* path);
+
+// maps and verifies the file, then replaces the circuit and the journal;
+// the current circuit is untouched unless the result is OK. The records
+// do not back the store directly: its trie nodes, member lists and sums
+// are rebuilt from them one record at a time, O(n) (about 0.3 s at 3M
+// parts), because the file holds none of those links.
+SnapshotStatus OpenSnapshot(const char* path);
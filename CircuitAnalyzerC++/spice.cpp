@@ -0,0 +1,299 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - SPICE netlist import
+ ********************************************************************/
+
+#include "spice.h"
+#include "mappedfile.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------- Tokenizer -------------------------
+
+// tokens are views into the input buffer: nothing is copied or allocated
+struct SpiceToken {
+    const char* p = nullptr;
+    int len = 0;
+};
+
+static bool IsSpiceSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '=' || c == '(' || c == ')';
+}
+
+// splits [p, end) into tokens, stopping at a ';' comment; returns the count
+static int TokenizeLine(const char* p, const char* end, SpiceToken* toks, int maxToks) {
+    int n = 0;
+    while (n < maxToks) {
+        while (p < end && IsSpiceSeparator(*p)) ++p;
+        if (p == end || *p == ';') break;
+        const char* start = p;
+        while (p < end && !IsSpiceSeparator(*p) && *p != ';') ++p;
+        toks[n].p = start;
+        toks[n].len = (int)(p - start);
+        n++;
+    }
+    return n;
+}
+
+static char LowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool TokenEquals(const SpiceToken& t, const char* word) {
+    int i = 0;
+    for (; i < t.len; ++i) {
+        if (word[i] == '\0' || LowerAscii(t.p[i]) != word[i]) return false;
+    }
+    return word[i] == '\0';
+}
+
+static bool TokenStartsWith(const SpiceToken& t, int from, const char* word) {
+    int n = (int)strlen(word);
+    if (t.len - from < n) return false;
+    for (int i = 0; i < n; ++i) {
+        if (LowerAscii(t.p[from + i]) != word[i]) return false;
+    }
+    return true;
+}
+
+// number with an optional SPICE scale suffix; trailing unit letters ignored
+static bool ParseSpiceValue(const SpiceToken& t, double& value) {
+    char buf[64];
+    if (t.len <= 0 || t.len >= (int)sizeof(buf)) return false;
+    memcpy(buf, t.p, t.len);
+    buf[t.len] = '\0';
+    char* end;
+    double v = strtod(buf, &end);
+    if (end == buf) return false;
+
+    int at = (int)(end - buf);
+    double scale = 1.0;
+    if (TokenStartsWith(t, at, "meg")) scale = 1e6;
+    else if (TokenStartsWith(t, at, "mil")) scale = 25.4e-6;
+    else if (at < t.len) {
+        switch (LowerAscii(t.p[at])) {
+        case 't': scale = 1e12; break;
+        case 'g': scale = 1e9; break;
+        case 'k': scale = 1e3; break;
+        case 'm': scale = 1e-3; break;
+        case 'u': scale = 1e-6; break;
+        case 'n': scale = 1e-9; break;
+        case 'p': scale = 1e-12; break;
+        case 'f': scale = 1e-15; break;
+        default: break;
+        }
+    }
+    value = v * scale;
+    return true;
+}
+
+// ---------------------- Node Names -------------------------
+
+// SPICE node names -> compact network nodes 1..n (0 stays ground). Numeric
+// names go through a dense table; the rest through a hash of views into
+// the input, so only a new name ever allocates.
+struct SpiceNodeTable {
+    std::vector<int> numeric;
+    std::unordered_map<std::string_view, int> named;
+    int next = 1;
+};
+
+const long SPICE_DENSE_NODE_LIMIT = 1 << 24;
+
+static int SpiceNodeIndex(SpiceNodeTable& table, const SpiceToken& t) {
+    if (TokenEquals(t, "gnd")) return 0;
+
+    long number = 0;
+    bool digits = true;
+    for (int i = 0; i < t.len && digits; ++i) {
+        if (t.p[i] < '0' || t.p[i] > '9') digits = false;
+        else if (number < SPICE_DENSE_NODE_LIMIT) number = number * 10 + (t.p[i] - '0');
+    }
+    if (digits && number == 0) return 0;
+    if (digits && number < SPICE_DENSE_NODE_LIMIT) {
+        if (number >= (long)table.numeric.size()) table.numeric.resize(number + 1, 0);
+        int& slot = table.numeric[number];
+        if (slot == 0) slot = table.next++;
+        return slot;
+    }
+    auto ins = table.named.emplace(std::string_view(t.p, t.len), table.next);
+    if (ins.second) table.next++;
+    return ins.first->second;
+}
+
+// ---------------------- Parser -------------------------
+
+// ".tran <step> <stop> [<start> [<max step>]]"; start is not supported
+// (the run always starts from rest at 0) and is ignored
+static bool ParseTranLine(const SpiceToken* toks, int n, TransientSettings& s) {
+    double step, stop, maxStep;
+    if (n < 3 || !ParseSpiceValue(toks[1], step) || !ParseSpiceValue(toks[2], stop)) return false;
+    maxStep = step;
+    if (n >= 5 && !ParseSpiceValue(toks[4], maxStep)) return false;
+    s.stopTime = stop;
+    s.maxStep = maxStep;
+    return TransientSettingsValid(s);
+}
+
+// "V<name> <a> <b> [[DC] <v>] [PULSE(v1 v2 td tr tf pw per)] ...": a PULSE
+// anywhere after the nodes drives the run (the DC value is only the
+// source's level at rest, v1 already gives that), with missing trailing
+// fields left at 0; without one the DC value is a step from 0 to v
+static bool ParseSourceWaveform(const SpiceToken* toks, int n, TransientSource& src) {
+    int at = 3;
+    double dc = 0.0;
+    bool hasDc = false;
+    if (at < n && TokenEquals(toks[at], "dc")) at++;
+    if (at < n && ParseSpiceValue(toks[at], dc)) {
+        hasDc = true;
+        at++;
+    }
+    for (int k = at; k < n; ++k) {
+        if (!TokenEquals(toks[k], "pulse")) continue;
+        double f[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        int count = 0;
+        // the parentheses are separators: the fields end at the first word
+        for (int i = k + 1; i < n && count < 7 && ParseSpiceValue(toks[i], f[count]); ++i) count++;
+        if (count < 2) return false;
+        src.v1 = f[0];
+        src.v2 = f[1];
+        src.delay = f[2];
+        src.rise = f[3];
+        src.fall = f[4];
+        src.width = f[5];
+        src.period = f[6];
+        return true;
+    }
+    if (!hasDc) return false;
+    src.v1 = 0.0;
+    src.v2 = dc;
+    return true;
+}
+
+// ".ac dec|oct|lin <n> <start> <stop>"
+static bool ParseAcLine(const SpiceToken* toks, int n, SweepSettings& s) {
+    if (n < 5) return false;
+    double count, start, stop;
+    if (!ParseSpiceValue(toks[2], count) || !ParseSpiceValue(toks[3], start) ||
+        !ParseSpiceValue(toks[4], stop) || count < 1.0 || start <= 0.0 || stop <= start) {
+        return false;
+    }
+    s.startHz = start;
+    s.stopHz = stop;
+    if (TokenEquals(toks[1], "lin")) {
+        s.scale = SweepScale::LINEAR;
+        s.points = (int)count;
+    }
+    else if (TokenEquals(toks[1], "dec")) {
+        s.scale = SweepScale::LOG;
+        s.points = (int)std::lround(count * std::log10(stop / start)) + 1;
+    }
+    else if (TokenEquals(toks[1], "oct")) {
+        s.scale = SweepScale::LOG;
+        s.points = (int)std::lround(count * std::log2(stop / start)) + 1;
+    }
+    else {
+        return false;
+    }
+    return SweepSettingsValid(s);
+}
+
+// tokens kept per card; "V1 in 0 DC 0 PULSE(v1 v2 td tr tf pw per)" is 13
+const int SPICE_MAX_TOKENS = 32;
+
+void ParseSpiceNetlist(const char* data, size_t size, Network& net, SpiceImportInfo& info) {
+    net = Network();
+    info = SpiceImportInfo();
+    SpiceNodeTable nodes;
+    int sourceNode = -1;     // input node taken from the first V/I source
+    SpiceToken toks[SPICE_MAX_TOKENS];
+
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        const char* line = p;
+        p = (eol < end) ? eol + 1 : end;
+        if (++info.lines == 1) continue;   // title
+
+        int n = TokenizeLine(line, eol, toks, SPICE_MAX_TOKENS);
+        if (n == 0) continue;
+        char first = LowerAscii(toks[0].p[0]);
+        if (first == '*') continue;
+        if (first == '+') {   // nothing to continue
+            info.skipped++;
+            continue;
+        }
+
+        // '+' lines continue the card, also across blank and '*' lines
+        int cardLine = info.lines;
+        while (p < end) {
+            const char* next = p;
+            const char* nextEol = (const char*)memchr(next, '\n', end - next);
+            if (!nextEol) nextEol = end;
+            const char* c = next;
+            while (c < nextEol && (*c == ' ' || *c == '\t' || *c == '\r')) ++c;
+            if (c < nextEol && *c != '+' && *c != '*') break;
+            p = (nextEol < end) ? nextEol + 1 : end;
+            info.lines++;
+            if (c < nextEol && *c == '+') n += TokenizeLine(c + 1, nextEol, toks + n, SPICE_MAX_TOKENS - n);
+        }
+
+        if (first == '.') {
+            if (TokenEquals(toks[0], ".end")) break;
+            if (TokenEquals(toks[0], ".ac")) {
+                if (ParseAcLine(toks, n, info.ac)) info.hasAc = true;
+                else if (info.errors++ == 0) info.firstErrorLine = cardLine;
+                continue;
+            }
+            if (TokenEquals(toks[0], ".tran")) {
+                if (ParseTranLine(toks, n, info.tran)) info.hasTran = true;
+                else if (info.errors++ == 0) info.firstErrorLine = cardLine;
+                continue;
+            }
+            info.skipped++;
+            continue;
+        }
+
+        ComponentType type;
+        if (first == 'r') type = ComponentType::RESISTOR;
+        else if (first == 'l') type = ComponentType::INDUCTOR;
+        else if (first == 'c') type = ComponentType::CAPACITOR;
+        else {
+            if ((first == 'v' || first == 'i') && sourceNode < 0 && n >= 3) {
+                int a = SpiceNodeIndex(nodes, toks[1]);
+                sourceNode = a != 0 ? a : SpiceNodeIndex(nodes, toks[2]);
+                if (first == 'v') ParseSourceWaveform(toks, n, info.tran.source);
+            }
+            info.skipped++;
+            continue;
+        }
+
+        double value;
+        if (n < 4 || !ParseSpiceValue(toks[3], value) || value <= 0.0) {
+            if (info.errors++ == 0) info.firstErrorLine = cardLine;
+            continue;
+        }
+        int a = SpiceNodeIndex(nodes, toks[1]);   // in file order: the first node seen is 1
+        int b = SpiceNodeIndex(nodes, toks[2]);
+        AddNetElement(net, type, value, a, b);
+    }
+
+    info.elements = (int)net.elements.size();
+    net.nodeCount = nodes.next;
+    if (sourceNode > 0) net.inputNode = sourceNode;
+    else if (nodes.numeric.size() > 1 && nodes.numeric[1] != 0) net.inputNode = nodes.numeric[1];
+    else net.inputNode = 1;
+}
+
+bool ImportSpiceFile(const char* path, Network& net, SpiceImportInfo& info) {
+    MappedFile mf;
+    if (!MapFile(path, mf)) return false;
+    ParseSpiceNetlist(mf.data, mf.size, net, info);
+    UnmapFile(mf);
+    return true;
+}
@@ -0,0 +1,43 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - SPICE netlist import
+ *
+ * Reads the R/L/C subset of a SPICE deck:
+ *     <title line>                 the first line is always the title
+ *     R1 in out 4.7k               R|L|C<name> <node> <node> <value>
+ *     V1 in 0 DC 0 PULSE(0 5 1u 1n 1n 10u 20u)   [DC <v>] PULSE(...) drives .tran
+ *     V2 in 0 5                    or "DC 5": a 0 -> 5 V step
+ *     .ac dec 20 10 1meg           dec|oct|lin <points> <start> <stop>
+ *     .tran 10n 50u                <step> <stop> [<start> [<max step>]]
+ *     .end
+ * Values take the SPICE scale suffixes (f p n u m k meg g t mil), any
+ * trailing unit letters are ignored ("10uF"). Node 0 or gnd is ground;
+ * names may be numbers or words. The first V or I source, if any, marks
+ * the input node (and a V source's value or PULSE drives .tran), otherwise node "1" (or the first node seen) does.
+ * '+' lines continue the card before them. '*' lines, ';' comments,
+ * other elements and other dot commands are skipped.
+ ********************************************************************/
+
+#pragma once
+
+#include "mna.h"
+#include "sweep.h"
+#include "transient.h"
+#include <cstddef>
+
+struct SpiceImportInfo {
+    int lines = 0;
+    int elements = 0;
+    int skipped = 0;          // unsupported elements, dot commands and stray '+' lines
+    int errors = 0;           // malformed R/L/C/.ac/.tran lines
+    int firstErrorLine = 0;
+    bool hasAc = false;       // .ac seen, `ac` holds its sweep
+    SweepSettings ac;
+    bool hasTran = false;     // .tran seen, `tran` holds its times and the first V source
+    TransientSettings tran;
+};
+
+// parses a whole deck held in memory (not NUL-terminated) into net
+void ParseSpiceNetlist(const char* data, size_t size, Network& net, SpiceImportInfo& info);
+
+// memory-maps the file and parses it; false if it cannot be opened
+bool ImportSpiceFile(const char* path, Network& net, SpiceImportInfo& info);
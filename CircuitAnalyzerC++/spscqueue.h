@@ -0,0 +1,46 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - single-producer/single-consumer queue
+ *
+ * Fixed ring of N slots (N a power of two). The producer only writes
+ * `tail`, the consumer only writes `head`; each publishes with a release
+ * store and reads the other side with an acquire load, so a slot is
+ * never touched by both threads at once and no lock is taken. The two
+ * indices sit on separate cache lines.
+ ********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+template <typename T, size_t N>
+struct SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+    T slots[N];
+    alignas(64) std::atomic<size_t> head{ 0 };   // next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail{ 0 };   // next slot to fill (producer)
+
+    // producer side; false when full
+    bool TryPush(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        slots[t & (N - 1)] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side; false when empty. The slot is left moved-from.
+    bool TryPop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        out = std::move(slots[h & (N - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,99 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - AC frequency sweep
+ ********************************************************************/
+
+#include "sweep.h"
+#include <cmath>
+
+bool SweepSettingsValid(const SweepSettings& s) {
+    return s.points >= 2 && s.startHz > 0.0 && s.stopHz > s.startHz;
+}
+
+double SweepFrequencyAt(const SweepSettings& s, int i) {
+    double t = (double)i / (double)(s.points - 1);
+    if (s.scale == SweepScale::LINEAR) return s.startHz + (s.stopHz - s.startHz) * t;
+    return s.startHz * std::pow(s.stopHz / s.startHz, t);
+}
+
+// Z(w) = sum(R) + j(w*sum(L) - sum(1/C)/w); zero capacitors are open (1e10)
+void EvalSeriesBlock(const CircuitSums& s, const double* freqHz, int n, double* re, double* im) {
+    const int R = (int)ComponentType::RESISTOR, L = (int)ComponentType::INDUCTOR, C = (int)ComponentType::CAPACITOR;
+    const double r = s.sum[R] + 1e10 * s.zeros[C];
+    const double l = s.sum[L];
+    const double cInv = (s.count[C] > s.zeros[C]) ? s.inv[C] : 0.0;
+    for (int i = 0; i < n; ++i) {
+        double omega = 2.0 * M_PI * freqHz[i];
+        re[i] = r;
+        im[i] = omega * l - cInv / omega;
+    }
+}
+
+// Y(w) = sum(1/R) + j(w*sum(C) - sum(1/L)/w), Z = 1/Y (0 when nothing conducts)
+void EvalParallelBlock(const CircuitSums& s, const double* freqHz, int n, double* re, double* im) {
+    const int R = (int)ComponentType::RESISTOR, L = (int)ComponentType::INDUCTOR, C = (int)ComponentType::CAPACITOR;
+    const double g = s.inv[R] + 1e-10 * s.zeros[C];
+    const double c = s.sum[C];
+    const double lInv = s.inv[L];
+    for (int i = 0; i < n; ++i) {
+        double omega = 2.0 * M_PI * freqHz[i];
+        double b = omega * c - lInv / omega;
+        double d = g * g + b * b;
+        double k = (d != 0.0) ? 1.0 / d : 0.0;
+        re[i] = g * k;
+        im[i] = -b * k;
+    }
+}
+
+void ToMagnitudePhase(const double* re, const double* im, int n, double* mag, double* phaseDeg) {
+    for (int i = 0; i < n; ++i) mag[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    for (int i = 0; i < n; ++i) phaseDeg[i] = std::atan2(im[i], re[i]) * (180.0 / M_PI);
+}
+
+void RunSweep(const SweepSettings& settings, SweepResult& out) {
+    int n = SweepSettingsValid(settings) ? settings.points : 0;
+    out.freqHz.resize(n);
+    out.seriesMag.resize(n);
+    out.seriesPhase.resize(n);
+    out.parallelMag.resize(n);
+    out.parallelPhase.resize(n);
+
+    double re[SWEEP_BLOCK], im[SWEEP_BLOCK];
+    for (int i = 0; i < n; ++i) out.freqHz[i] = SweepFrequencyAt(settings, i);
+    for (int b = 0; b < n; b += SWEEP_BLOCK) {
+        int m = (n - b < SWEEP_BLOCK) ? n - b : SWEEP_BLOCK;
+        const double* f = &out.freqHz[b];
+        EvalSeriesBlock(seriesSums, f, m, re, im);
+        ToMagnitudePhase(re, im, m, &out.seriesMag[b], &out.seriesPhase[b]);
+        EvalParallelBlock(parallelSums, f, m, re, im);
+        ToMagnitudePhase(re, im, m, &out.parallelMag[b], &out.parallelPhase[b]);
+    }
+}
+
+bool WriteSweepCsv(FILE* out, const SweepSettings& settings) {
+    if (!SweepSettingsValid(settings)) return false;
+
+    double f[SWEEP_BLOCK], re[SWEEP_BLOCK], im[SWEEP_BLOCK];
+    double sMag[SWEEP_BLOCK], sPh[SWEEP_BLOCK], pMag[SWEEP_BLOCK], pPh[SWEEP_BLOCK];
+
+    fprintf(out, "freq_hz,series_mag_ohm,series_phase_deg,parallel_mag_ohm,parallel_phase_deg\n");
+    for (int b = 0; b < settings.points; b += SWEEP_BLOCK) {
+        int m = (settings.points - b < SWEEP_BLOCK) ? settings.points - b : SWEEP_BLOCK;
+        for (int i = 0; i < m; ++i) f[i] = SweepFrequencyAt(settings, b + i);
+        EvalSeriesBlock(seriesSums, f, m, re, im);
+        ToMagnitudePhase(re, im, m, sMag, sPh);
+        EvalParallelBlock(parallelSums, f, m, re, im);
+        ToMagnitudePhase(re, im, m, pMag, pPh);
+        for (int i = 0; i < m; ++i) {
+            fprintf(out, "%.6g,%.6g,%.3f,%.6g,%.3f\n", f[i], sMag[i], sPh[i], pMag[i], pPh[i]);
+        }
+    }
+    return !ferror(out);
+}
+
+bool WriteSweepCsv(const char* path, const SweepSettings& settings) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+    bool ok = WriteSweepCsv(out, settings);
+    ok = (fclose(out) == 0) && ok;
+    return ok;
+}
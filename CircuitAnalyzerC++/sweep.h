@@ -0,0 +1,50 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - AC frequency sweep
+ *
+ * Evaluates the series and parallel impedance over a whole vector of
+ * frequencies. Both circuits reduce to their per-type totals
+ * (CircuitSums), so each point costs a few multiply-adds; the kernels
+ * run over frequency blocks held in plain arrays so the compiler can
+ * vectorize across points.
+ ********************************************************************/
+
+#pragma once
+
+#include "circuitcore.h"
+#include <vector>
+#include <cstdio>
+
+enum class SweepScale { LINEAR = 0, LOG = 1 };
+
+struct SweepSettings {
+    double startHz = 10.0;
+    double stopHz = 1.0e6;
+    int points = 1000;
+    SweepScale scale = SweepScale::LOG;
+};
+
+// Bode data: magnitude in Ohm, phase in degrees
+struct SweepResult {
+    std::vector<double> freqHz;
+    std::vector<double> seriesMag;
+    std::vector<double> seriesPhase;
+    std::vector<double> parallelMag;
+    std::vector<double> parallelPhase;
+};
+
+// points per kernel call; keeps a block's inputs and outputs in L1
+const int SWEEP_BLOCK = 1024;
+
+bool SweepSettingsValid(const SweepSettings& s);
+double SweepFrequencyAt(const SweepSettings& s, int i);
+
+// complex impedance of one circuit at n frequencies, split into re/im arrays
+void EvalSeriesBlock(const CircuitSums& s, const double* freqHz, int n, double* re, double* im);
+void EvalParallelBlock(const CircuitSums& s, const double* freqHz, int n, double* re, double* im);
+
+// sweep of the current circuits held in memory (plots, small sweeps)
+void RunSweep(const SweepSettings& settings, SweepResult& out);
+
+// streams the sweep block by block as CSV; memory stays O(SWEEP_BLOCK)
+bool WriteSweepCsv(FILE* out, const SweepSettings& settings);
+bool WriteSweepCsv(const char* path, const SweepSettings& settings);
@@ -0,0 +1,51 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - allocation counter tests
+ ********************************************************************/
+
+#include "tests.h"
+#include "../allocstats.h"
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+struct alignas(64) CacheLine {
+    double v[8];
+};
+
+// an allocation whose pointer escapes may not be elided by the optimizer
+static void* volatile escaped;
+
+template <typename T>
+static T* Keep(T* p) {
+    escaped = p;
+    return p;
+}
+
+// plain and over-aligned allocations, single and array, throwing and
+// nothrow, each count once and come back at their alignment
+static void AllocCounts() {
+    long long start = AllocationCount();
+    delete Keep(new int(1));
+    delete[] Keep(new int[3]);
+    CHECK(AllocationCount() - start == 2);
+
+    start = AllocationCount();
+    CacheLine* one = Keep(new CacheLine());
+    CacheLine* many = Keep(new CacheLine[5]);
+    CacheLine* quiet = Keep(new (std::nothrow) CacheLine());
+    CHECK(AllocationCount() - start == 3);
+    CHECK((uintptr_t)one % 64 == 0 && (uintptr_t)many % 64 == 0 && (uintptr_t)quiet % 64 == 0);
+    delete one;
+    delete[] many;
+    delete quiet;
+
+    start = AllocationCount();
+    std::vector<CacheLine> lines(100);
+    Keep(lines.data());
+    CHECK(AllocationCount() - start == 1 && (uintptr_t)lines.data() % 64 == 0);
+}
+
+void AddAllocTests(std::vector<TestCase>& cases) {
+    cases.push_back({ "AllocCounts", AllocCounts });
+}
@@ -0,0 +1,148 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - edit, member list and undo/redo tests
+ ********************************************************************/
+
+#include "tests.h"
+#include <cmath>
+#include <random>
+
+PartMap CircuitParts() {
+    PartMap parts;
+    for (const Component& c : componentsData) parts.emplace(c.id, c);
+    return parts;
+}
+
+static bool SameParts(const PartMap& a, const PartMap& b) {
+    if (a.size() != b.size()) return false;
+    for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+        const Component& x = i->second;
+        const Component& y = j->second;
+        if (x.id != y.id || x.type != y.type || x.value != y.value ||
+            x.circuitType != y.circuitType || x.tolerance != y.tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the running sums add and subtract, so they carry round-off of the
+// largest totals seen since the last resync, not of the current ones
+static bool Close(double running, double exact) {
+    return std::fabs(running - exact) <= 1e-9 * (std::fabs(exact) + 1.0);
+}
+
+static bool SameSums(const CircuitSums& a, const CircuitSums& b) {
+    for (int t = 0; t < 3; ++t) {
+        if (a.count[t] != b.count[t] || a.zeros[t] != b.zeros[t]) return false;
+        if (!Close(a.sum[t], b.sum[t]) || !Close(a.inv[t], b.inv[t])) return false;
+    }
+    return true;
+}
+
+void CheckCircuit() {
+    // each part's handle is its own node, in the list of its circuit
+    std::vector<int> series, parallel;
+    for (const Component& c : componentsData) {
+        bool s = c.circuitType == CircuitType::SERIES;
+        (s ? series : parallel).push_back(c.id);
+        const MemberList& members = s ? seriesCircuit : parallelCircuit;
+        if (!CHECK(c.member >= 0 && c.member < (int)members.nodes.size())) return;
+        CHECK(members.nodes[c.member].id == c.id);
+    }
+    // both lists hold exactly their circuit's ids, ascending
+    CHECK(std::vector<int>(seriesCircuit.begin(), seriesCircuit.end()) == series);
+    CHECK(std::vector<int>(parallelCircuit.begin(), parallelCircuit.end()) == parallel);
+    CHECK(seriesCircuit.size() == series.size() && parallelCircuit.size() == parallel.size());
+    CHECK(SameSums(seriesSums, SumComponents(componentsData, CircuitType::SERIES)));
+    CHECK(SameSums(parallelSums, SumComponents(componentsData, CircuitType::PARALLEL)));
+    CHECK(componentsData.empty() || componentsData.LowerBound(0)->id < nextId);
+}
+
+void CheckCircuitIs(const PartMap& expected) {
+    CHECK(SameParts(CircuitParts(), expected));
+    CheckCircuit();
+}
+
+CircuitType RandomCircuit(std::mt19937& rng) {
+    return (rng() & 1) ? CircuitType::PARALLEL : CircuitType::SERIES;
+}
+
+// single adds and removes, filtered range removes and undo/redo runs,
+// checked against EditModel after every step
+static void EditModelCheck(unsigned seed) {
+    std::mt19937 rng(seed);
+    EditModel model;
+    for (int step = 0; step < 4000; ++step) {
+        int op = (int)(rng() % 10);
+        PartMap before = model.parts;
+        if (op <= 2) {
+            ComponentType type = (ComponentType)(rng() % 3);
+            double value = (rng() % 8) == 0 ? 0.0 : 1.0 + rng() % 1000;
+            CircuitType circuit = RandomCircuit(rng);
+            int id = nextId;
+            AddComponent(type, value, circuit);
+            model.parts.emplace(id, Component(id, type, value, circuit));
+            model.Edited(before);
+        }
+        else if (op <= 4) {
+            int id = 1 + (int)(rng() % (unsigned)nextId);
+            bool present = model.parts.erase(id) == 1;
+            CHECK(RemoveComponent(id) == present);
+            if (present) model.Edited(before);
+        }
+        else if (op == 5) {
+            int first = (int)(rng() % (unsigned)nextId);
+            int last = first + (int)(rng() % 40);
+            int mod = 2 + (int)(rng() % 3);
+            int removed = 0;
+            for (auto it = model.parts.lower_bound(first); it != model.parts.end() && it->first <= last;) {
+                if (it->first % mod != 0) { it = model.parts.erase(it); removed++; }
+                else ++it;
+            }
+            CHECK(RemoveComponents(first, last, [mod](const Component& c) { return c.id % mod != 0; }) == removed);
+            if (removed > 0) model.Edited(before);
+        }
+        else if (op <= 7) {
+            int runs = 1 + (int)(rng() % 4);
+            for (int k = 0; k < runs; ++k) { Undo(); model.Undo(); }
+        }
+        else {
+            int runs = 1 + (int)(rng() % 4);
+            for (int k = 0; k < runs; ++k) { Redo(); model.Redo(); }
+        }
+        CheckCircuitIs(model.parts);
+        CHECK(undoJournal.size() == model.undo.size() && redoStack.size() == model.redo.size());
+    }
+
+    // all the way back and forward again
+    while (!model.undo.empty()) { Undo(); model.Undo(); CheckCircuitIs(model.parts); }
+    while (!model.redo.empty()) { Redo(); model.Redo(); CheckCircuitIs(model.parts); }
+}
+
+// undoing a remove puts the part back between its old neighbours, also
+// when an unjournaled append changed them in between (a stale hint)
+static void RelinkStaleSuccessor() {
+    for (int i = 0; i < 6; ++i) AddComponent(ComponentType::RESISTOR, 10.0 + i, CircuitType::SERIES);
+    RemoveComponent(3);             // successor hint: 4
+    RemoveComponent(4);             // successor hint: 5
+    Undo();
+    Undo();
+    CHECK(std::vector<int>(seriesCircuit.begin(), seriesCircuit.end()) == std::vector<int>({ 1, 2, 3, 4, 5, 6 }));
+    Redo();
+    Redo();
+    CHECK(std::vector<int>(seriesCircuit.begin(), seriesCircuit.end()) == std::vector<int>({ 1, 2, 5, 6 }));
+    CheckCircuit();
+
+    RemoveComponent(6);             // recorded as the last member
+    AppendComponent(ComponentType::RESISTOR, 1.0, CircuitType::SERIES);   // id 7, not journaled
+    Undo();
+    CHECK(std::vector<int>(seriesCircuit.begin(), seriesCircuit.end()) == std::vector<int>({ 1, 2, 5, 6, 7 }));
+    CheckCircuit();
+}
+
+void AddEditTests(std::vector<TestCase>& cases) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        cases.push_back({ "EditModel/" + std::to_string(seed), [seed] { EditModelCheck(seed); } });
+    }
+    cases.push_back({ "RelinkStaleSuccessor", RelinkStaleSuccessor });
+}
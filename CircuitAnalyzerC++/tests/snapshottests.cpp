@@ -0,0 +1,234 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - snapshot file tests
+ ********************************************************************/
+
+#include "tests.h"
+#include "../snapshot.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+static const char* TEST_SNAPSHOT = "circuit_tests.snap";
+
+static std::vector<char> ReadFileBytes(const char* path) {
+    std::vector<char> bytes;
+    FILE* f = fopen(path, "rb");
+    if (!f) return bytes;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    fclose(f);
+    return bytes;
+}
+
+static void WriteFileBytes(const char* path, const std::vector<char>& bytes) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(bytes.data(), 1, bytes.size(), f);
+    fclose(f);
+}
+
+// FNV-1a over 64-bit words, as snapshot.cpp computes it
+static uint64_t Fnv(uint64_t h, const void* data, size_t bytes) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// a file of an older (or the current) version, written field by field
+static std::vector<char> BuildSnapshotFile(uint32_t version, int32_t nextIdValue, double freqHz,
+    const std::vector<SnapshotRecord>& table, const std::vector<SnapshotRecord>& journal) {
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CIRCSNAP", 8);
+    h.version = version;
+    h.headerSize = sizeof(SnapshotHeader);
+    h.componentCount = table.size();
+    h.journalCount = journal.size();
+    h.nextId = nextIdValue;
+    h.analysisFreqHz = freqHz;
+    std::vector<SnapshotRecord> records(table);
+    records.insert(records.end(), journal.begin(), journal.end());
+    uint64_t seed = version >= 3 ? Fnv(1469598103934665603ULL, &h, sizeof(h)) : 1469598103934665603ULL;
+    h.checksum = Fnv(seed, records.data(), records.size() * sizeof(SnapshotRecord));
+
+    std::vector<char> bytes(sizeof(h) + records.size() * sizeof(SnapshotRecord));
+    memcpy(bytes.data(), &h, sizeof(h));
+    if (!records.empty()) memcpy(bytes.data() + sizeof(h), records.data(), records.size() * sizeof(SnapshotRecord));
+    return bytes;
+}
+
+static std::vector<int> Ids(const PartMap& parts) {
+    std::vector<int> ids;
+    for (const auto& kv : parts) ids.push_back(kv.first);
+    return ids;
+}
+
+static SnapshotRecord Record(int32_t id, ComponentType type, CircuitType circuit, double value, uint8_t added) {
+    SnapshotRecord r;
+    memset(&r, 0, sizeof(r));
+    r.id = id;
+    r.type = (uint8_t)type;
+    r.circuit = (uint8_t)circuit;
+    r.added = added;
+    r.value = value;
+    return r;
+}
+
+// random single, bulk and transaction edits, saved and opened again: same
+// parts, ids and frequency, and the reopened journal undoes through the
+// same states as the original one
+static void SnapshotRoundTrip(unsigned seed) {
+    std::mt19937 rng(seed);
+    EditModel model;
+    for (int step = 0; step < 300; ++step) {
+        PartMap before = CircuitParts();
+        int op = (int)(rng() % 6);
+        if (op <= 1) {
+            AddComponent((ComponentType)(rng() % 3), 1.0 + rng() % 100, RandomCircuit(rng), (rng() % 30) / 1000.0);
+        }
+        else if (op == 2) {
+            RemoveComponent(1 + (int)(rng() % (unsigned)nextId));
+        }
+        else if (op == 3) {
+            ComponentSpec specs[8];
+            int count = 2 + (int)(rng() % 7);
+            for (int k = 0; k < count; ++k) specs[k] = { ComponentType::CAPACITOR, 1e-6 * (k + 1), RandomCircuit(rng), 0.05 };
+            AddComponents(specs, count);
+        }
+        else if (op == 4) {
+            int first = 1 + (int)(rng() % (unsigned)nextId);
+            RemoveComponents(first, first + 20, [](const Component& c) { return c.type != ComponentType::INDUCTOR; });
+        }
+        else {
+            Undo();
+            model.Undo();
+            continue;
+        }
+        // every journaled edit adds or removes ids
+        if (Ids(CircuitParts()) != Ids(before)) model.Edited(before);
+        model.parts = CircuitParts();
+    }
+    CHECK(undoJournal.size() == model.undo.size());
+
+    analysisFrequencyHz = 60.0 + seed;
+    int savedNextId = nextId;
+    CHECK(SaveSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    AddComponent(ComponentType::RESISTOR, 5.0, CircuitType::SERIES);   // replaced by the open
+    analysisFrequencyHz = 50.0;
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(nextId == savedNextId && analysisFrequencyHz == 60.0 + seed);
+    CHECK(redoStack.empty() && undoJournal.size() == model.undo.size());
+    model.redo.clear();
+    CheckCircuitIs(model.parts);
+
+    while (!model.undo.empty()) { Undo(); model.Undo(); CheckCircuitIs(model.parts); }
+    while (!model.redo.empty()) { Redo(); model.Redo(); CheckCircuitIs(model.parts); }
+    remove(TEST_SNAPSHOT);
+}
+
+// version 1 (single entries) and 2 (bulk runs) files, whose checksum
+// covers the records only, still open and undo
+static void SnapshotOldVersions() {
+    std::vector<SnapshotRecord> table = {
+        Record(1, ComponentType::RESISTOR, CircuitType::SERIES, 100.0, SNAPSHOT_ADDED),
+        Record(3, ComponentType::CAPACITOR, CircuitType::PARALLEL, 1e-6, SNAPSHOT_ADDED),
+    };
+    // v1: add 3, remove 2
+    std::vector<SnapshotRecord> journal = {
+        Record(3, ComponentType::CAPACITOR, CircuitType::PARALLEL, 1e-6, SNAPSHOT_ADDED),
+        Record(2, ComponentType::INDUCTOR, CircuitType::SERIES, 0.1, 0),
+    };
+    WriteFileBytes(TEST_SNAPSHOT, BuildSnapshotFile(1, 4, 50.0, table, journal));
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(componentsData.size() == 2 && undoJournal.size() == 2 && nextId == 4);
+    Undo();
+    CHECK(FindComponent(2) != nullptr && FindComponent(2)->type == ComponentType::INDUCTOR);
+    Undo();
+    CHECK(FindComponent(3) == nullptr && componentsData.size() == 2);
+    CheckCircuit();
+
+    // a bulk run is not valid in version 1
+    journal[0].added |= SNAPSHOT_MORE;
+    WriteFileBytes(TEST_SNAPSHOT, BuildSnapshotFile(1, 4, 50.0, table, journal));
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::BAD_FORMAT);
+
+    // v2: the same two as one bulk entry
+    WriteFileBytes(TEST_SNAPSHOT, BuildSnapshotFile(2, 4, 50.0, table, journal));
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(undoJournal.size() == 1 && undoJournal.back().batch);
+    Undo();
+    CHECK(FindComponent(2) != nullptr && FindComponent(3) == nullptr);
+    Redo();
+    CHECK(FindComponent(2) == nullptr && FindComponent(3) != nullptr);
+    CheckCircuit();
+    remove(TEST_SNAPSHOT);
+}
+
+// any damaged byte, header included, is refused and leaves the circuit as it was
+static void SnapshotDamage() {
+    for (int i = 0; i < 10; ++i) AddComponent(ComponentType::RESISTOR, 10.0 * (i + 1), (i & 1) ? CircuitType::PARALLEL : CircuitType::SERIES);
+    RemoveComponent(4);
+    CHECK(SaveSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    std::vector<char> good = ReadFileBytes(TEST_SNAPSHOT);
+    CHECK(good.size() == sizeof(SnapshotHeader) + (9 + 11) * sizeof(SnapshotRecord));   // 9 parts, 11 entries
+
+    AddComponent(ComponentType::INDUCTOR, 1.0, CircuitType::SERIES);
+    PartMap current = CircuitParts();
+    const size_t fields[] = {
+        offsetof(SnapshotHeader, nextId), offsetof(SnapshotHeader, analysisFreqHz),
+        offsetof(SnapshotHeader, reserved), offsetof(SnapshotHeader, padding),
+        sizeof(SnapshotHeader) + 5 * sizeof(SnapshotRecord) + offsetof(SnapshotRecord, value),
+    };
+    for (size_t at : fields) {
+        std::vector<char> bad = good;
+        bad[at] ^= 0x10;
+        WriteFileBytes(TEST_SNAPSHOT, bad);
+        CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::BAD_CHECKSUM);
+        CheckCircuitIs(current);
+    }
+    std::vector<char> cut(good.begin(), good.end() - 8);
+    WriteFileBytes(TEST_SNAPSHOT, cut);
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::BAD_FORMAT);
+    CheckCircuitIs(current);
+
+    // a well-formed file with an infinite frequency keeps the current one
+    analysisFrequencyHz = 50.0;
+    std::vector<SnapshotRecord> table = { Record(1, ComponentType::RESISTOR, CircuitType::SERIES, 1.0, SNAPSHOT_ADDED) };
+    WriteFileBytes(TEST_SNAPSHOT, BuildSnapshotFile(SNAPSHOT_VERSION, 2, std::numeric_limits<double>::infinity(), table, {}));
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(analysisFrequencyHz == 50.0 && componentsData.size() == 1);
+    remove(TEST_SNAPSHOT);
+}
+
+// a tolerance the record cannot hold is refused before anything is
+// written; one that fits comes back exactly
+static void SnapshotTolerance() {
+    remove(TEST_SNAPSHOT);
+    AddComponent(ComponentType::RESISTOR, 1.0, CircuitType::SERIES, 0.0125);
+    CHECK(SaveSnapshot(TEST_SNAPSHOT) == SnapshotStatus::BAD_TOLERANCE);
+    CHECK(ReadFileBytes(TEST_SNAPSHOT).empty());
+    Undo();   // only in the redo stack now, which is not saved
+    CHECK(SaveSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+
+    AddComponent(ComponentType::RESISTOR, 1.0, CircuitType::SERIES, 0.255);
+    CHECK(SaveSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(OpenSnapshot(TEST_SNAPSHOT) == SnapshotStatus::OK);
+    CHECK(FindComponent(2) != nullptr && FindComponent(2)->tolerance == 0.255);
+    remove(TEST_SNAPSHOT);
+}
+
+void AddSnapshotTests(std::vector<TestCase>& cases) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        cases.push_back({ "SnapshotRoundTrip/" + std::to_string(seed), [seed] { SnapshotRoundTrip(seed); } });
+    }
+    cases.push_back({ "SnapshotOldVersions", SnapshotOldVersions });
+    cases.push_back({ "SnapshotDamage", SnapshotDamage });
+    cases.push_back({ "SnapshotTolerance", SnapshotTolerance });
+}
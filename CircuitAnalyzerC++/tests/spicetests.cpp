@@ -0,0 +1,123 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - SPICE import tests
+ ********************************************************************/
+
+#include "tests.h"
+#include "../spice.h"
+#include <cmath>
+#include <cstring>
+
+static void ParseDeck(const char* deck, Network& net, SpiceImportInfo& info) {
+    ParseSpiceNetlist(deck, strlen(deck), net, info);
+}
+
+static bool Near(double a, double b) {
+    return std::fabs(a - b) <= 1e-12 * std::fabs(b);
+}
+
+// elements, scale suffixes, node names, dot cards and what is skipped
+static void SpiceElements() {
+    Network net;
+    SpiceImportInfo info;
+    ParseDeck("title line R1 1 2 5\n"
+        "R1 in mid 4.7k\n"
+        "* comment\n"
+        "c2 MID 0 10uF ; trailing comment\n"
+        "L3 mid gnd 1meg\n"
+        "r4 in 0 2mil\n"
+        "Q1 a b c model\n"
+        ".option whatever\n"
+        "R5 1 2 -3\n"
+        ".ac dec 10 10 1k\n"
+        ".tran 1u 2m\n"
+        ".end\n"
+        "R6 1 2 1\n", net, info);
+    CHECK(info.elements == 4 && net.elements.size() == 4);
+    CHECK(info.skipped == 2 && info.errors == 1 && info.firstErrorLine == 9);
+    if (net.elements.size() == 4) {
+        CHECK(net.elements[0].comp.type == ComponentType::RESISTOR && Near(net.elements[0].comp.value, 4.7e3));
+        CHECK(net.elements[1].comp.type == ComponentType::CAPACITOR && Near(net.elements[1].comp.value, 10e-6));
+        CHECK(net.elements[2].comp.type == ComponentType::INDUCTOR && Near(net.elements[2].comp.value, 1e6));
+        CHECK(Near(net.elements[3].comp.value, 2 * 25.4e-6));
+        // "in" is the first node seen, names are case-sensitive, gnd and 0 are ground
+        CHECK(net.elements[0].nodeA == 1 && net.elements[0].nodeB == 2);
+        CHECK(net.elements[1].nodeA == 3 && net.elements[1].nodeB == 0);
+        CHECK(net.elements[2].nodeA == 2 && net.elements[2].nodeB == 0);
+    }
+    CHECK(net.nodeCount == 4 && net.inputNode == 1);
+    CHECK(info.hasAc && info.ac.scale == SweepScale::LOG && info.ac.points == 21);
+    CHECK(info.hasTran && Near(info.tran.stopTime, 2e-3) && Near(info.tran.maxStep, 1e-6));
+}
+
+// the .tran source of a deck whose only element line is `source`
+static bool ParseSource(const char* source, TransientSource& src) {
+    std::string deck = std::string("source test\nR1 in 0 1k\n") + source + "\n.tran 1u 1m\n";
+    Network net;
+    SpiceImportInfo info;
+    ParseSpiceNetlist(deck.data(), deck.size(), net, info);
+    src = info.tran.source;
+    return info.hasTran && info.errors == 0;
+}
+
+static bool SamePulse(const TransientSource& s, double v1, double v2, double delay, double rise,
+    double fall, double width, double period) {
+    return Near(s.v1, v1) && Near(s.v2, v2) && s.delay == delay && s.rise == rise &&
+        s.fall == fall && s.width == width && s.period == period;
+}
+
+// "DC x PULSE(...)" is the usual spelling: the pulse drives the run
+static void SpiceSourceWaveforms() {
+    TransientSource s;
+    CHECK(ParseSource("V1 in 0 DC 0 PULSE(0 5 1u 1n 1n 1m 2m)", s));
+    CHECK(SamePulse(s, 0.0, 5.0, 1e-6, 1e-9, 1e-9, 1e-3, 2e-3));
+
+    CHECK(ParseSource("V1 in 0 PULSE(0 5 1u 1n 1n 1m 2m)", s));
+    CHECK(SamePulse(s, 0.0, 5.0, 1e-6, 1e-9, 1e-9, 1e-3, 2e-3));
+
+    CHECK(ParseSource("V1 in 0 dc 2 pulse(1 3) ac 1", s));
+    CHECK(SamePulse(s, 1.0, 3.0, 0.0, 0.0, 0.0, 0.0, 0.0));
+
+    CHECK(ParseSource("V1 in 0 5", s));
+    CHECK(SamePulse(s, 0.0, 5.0, 0.0, 0.0, 0.0, 0.0, 0.0));
+
+    CHECK(ParseSource("V1 in 0 DC 12", s));
+    CHECK(SamePulse(s, 0.0, 12.0, 0.0, 0.0, 0.0, 0.0, 0.0));
+
+    // nothing usable leaves the default step
+    CHECK(ParseSource("V1 in 0 PULSE(1)", s));
+    CHECK(SamePulse(s, TransientSource().v1, TransientSource().v2, 0.0, 0.0, 0.0, 0.0, 0.0));
+}
+
+// '+' lines join the card above them, across blank and '*' lines; one
+// with no card to continue is skipped
+static void SpiceContinuations() {
+    Network net;
+    SpiceImportInfo info;
+    ParseDeck("continuations\n"
+        "+ 1 2 3\n"
+        "V1 in 0 DC 0\n"
+        "+ PULSE(0 5 1u\n"
+        "* the rest\n"
+        "\n"
+        "+   1n 1n 1m 2m)\n"
+        "R1 in out\n"
+        "  + 2.2k\n"
+        ".ac dec 10\n"
+        "+ 10 1k\n"
+        ".tran 1u\n"
+        "+ 2m\n"
+        "C1 out 0\n"
+        "R2 out 0 1k\n", net, info);
+    CHECK(info.lines == 15 && info.skipped == 2);
+    CHECK(info.errors == 1 && info.firstErrorLine == 14);
+    CHECK(net.elements.size() == 2 && Near(net.elements[0].comp.value, 2.2e3));
+    CHECK(info.hasAc && info.ac.points == 21);
+    CHECK(info.hasTran && Near(info.tran.stopTime, 2e-3));
+    CHECK(SamePulse(info.tran.source, 0.0, 5.0, 1e-6, 1e-9, 1e-9, 1e-3, 2e-3));
+}
+
+void AddSpiceTests(std::vector<TestCase>& cases) {
+    cases.push_back({ "SpiceElements", SpiceElements });
+    cases.push_back({ "SpiceSourceWaveforms", SpiceSourceWaveforms });
+    cases.push_back({ "SpiceContinuations", SpiceContinuations });
+}
@@ -0,0 +1,101 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - component store tests
+ ********************************************************************/
+
+#include "tests.h"
+#include <map>
+#include <random>
+
+typedef std::map<int, double> StoreModel;   // id -> value
+
+// every way of reading the store agrees with the model
+static void CheckStore(const ComponentStore& store, const StoreModel& model, std::mt19937& rng) {
+    CHECK(store.size() == model.size());
+    auto m = model.begin();
+    size_t visited = 0;
+    for (const Component& c : store) {
+        if (!CHECK(m != model.end())) return;
+        CHECK(c.id == m->first && c.value == m->second);
+        ++m;
+        visited++;
+    }
+    CHECK(visited == model.size());
+
+    for (int k = 0; k < 20; ++k) {
+        int id = (k & 1) ? (int)(rng() % (unsigned)MAX_COMPONENT_ID) + 1 : (int)(rng() % 4096);
+        const Component* c = store.Find(id);
+        auto it = model.find(id);
+        CHECK((c != nullptr) == (it != model.end()));
+        if (c && it != model.end()) CHECK(c->value == it->second);
+
+        auto lb = store.LowerBound(id);
+        auto mlb = model.lower_bound(id);
+        CHECK((lb == store.end()) == (mlb == model.end()));
+        if (lb != store.end() && mlb != model.end()) CHECK(lb->id == mlb->first);
+    }
+}
+
+// random puts and erases, mostly dense ids plus a few up to MAX_COMPONENT_ID,
+// with copies taken along the way that later edits must not change
+static void StoreModelCheck(unsigned seed) {
+    std::mt19937 rng(seed);
+    ComponentStore store;
+    StoreModel model;
+    std::vector<std::pair<ComponentStore, StoreModel> > copies;
+
+    for (int op = 0; op < 20000; ++op) {
+        int r = (int)(rng() % 100);
+        int id = r < 95 ? 1 + (int)(rng() % 3000) : 1 + (int)(rng() % (unsigned)MAX_COMPONENT_ID);
+        if (r % 3 != 0) {
+            double value = 1.0 + rng() % 1000;
+            store.Put(Component(id, ComponentType::RESISTOR, value, CircuitType::SERIES));
+            model[id] = value;
+        }
+        else {
+            CHECK(store.Erase(id) == (model.erase(id) == 1));
+        }
+        if (op % 2000 == 0) copies.push_back({ store, model });
+        if (op % 500 == 0) CheckStore(store, model, rng);
+    }
+    CheckStore(store, model, rng);
+    for (const auto& copy : copies) CheckStore(copy.first, copy.second, rng);
+
+    // erasing everything leaves an empty store
+    for (const auto& kv : StoreModel(model)) {
+        CHECK(store.Erase(kv.first));
+        model.erase(kv.first);
+    }
+    CheckStore(store, model, rng);
+    CHECK(store.begin() == store.end());
+}
+
+// the trie grows to its full height and shrinks back
+static void StoreExtremeIds() {
+    std::mt19937 rng(1);
+    ComponentStore store;
+    StoreModel model;
+    const int ids[] = { 1, 31, 32, 1 << 20, 1 << 30, MAX_COMPONENT_ID - 1, MAX_COMPONENT_ID };
+    for (int id : ids) {
+        store.Put(Component(id, ComponentType::CAPACITOR, id * 0.5, CircuitType::PARALLEL));
+        model[id] = id * 0.5;
+    }
+    CheckStore(store, model, rng);
+    CHECK(store.LowerBound(MAX_COMPONENT_ID)->id == MAX_COMPONENT_ID);
+    CHECK(store.LowerBound(MAX_COMPONENT_ID + 1) == store.end());
+    CHECK(store.Find(0) == nullptr && store.Find(-5) == nullptr);
+
+    ComponentStore copy = store;
+    CHECK(store.Erase(MAX_COMPONENT_ID) && store.Erase(1 << 30));
+    CHECK(!store.Erase(1 << 30));
+    CHECK(copy.Find(MAX_COMPONENT_ID) != nullptr && copy.size() == model.size());
+    model.erase(MAX_COMPONENT_ID);
+    model.erase(1 << 30);
+    CheckStore(store, model, rng);
+}
+
+void AddStoreTests(std::vector<TestCase>& cases) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        cases.push_back({ "StoreModel/" + std::to_string(seed), [seed] { StoreModelCheck(seed); } });
+    }
+    cases.push_back({ "StoreExtremeIds", StoreExtremeIds });
+}
@@ -0,0 +1,50 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - regression test build (no raylib)
+ ********************************************************************/
+
+#include "tests.h"
+#include <cstdio>
+#include <cstring>
+
+static int caseFailures = 0;
+
+bool TestCheck(bool ok, const char* expr, const char* file, int line) {
+    if (!ok) {
+        caseFailures++;
+        std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expr);
+    }
+    return ok;
+}
+
+int RunTests(int argc, char** argv, const std::vector<TestCase>& cases) {
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+    }
+
+    int run = 0, failed = 0;
+    for (const TestCase& tc : cases) {
+        if (!filter.empty() && tc.name.find(filter) == std::string::npos) continue;
+        ClearCircuit();   // every case starts from an empty circuit
+        caseFailures = 0;
+        tc.run();
+        run++;
+        if (caseFailures > 0) failed++;
+        std::printf("%s %s\n", caseFailures > 0 ? "FAIL" : "ok  ", tc.name.c_str());
+        std::fflush(stdout);
+    }
+    ClearCircuit();
+    std::printf("%d of %d cases passed\n", run - failed, run);
+    return failed > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    std::vector<TestCase> cases;
+    AddStoreTests(cases);
+    AddEditTests(cases);
+    AddTransactionTests(cases);
+    AddSnapshotTests(cases);
+    AddSpiceTests(cases);
+    AddAllocTests(cases);
+    return RunTests(argc, argv, cases);
+}
@@ -0,0 +1,76 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - regression tests
+ *
+ * Plain functions registered by name, like the benchmark cases; a failed
+ * CHECK prints its file, line and expression and marks the case failed,
+ * and the case keeps going. circuit_tests runs every case (or those whose
+ * name contains --filter text) and exits non-zero if any check failed.
+ ********************************************************************/
+
+#pragma once
+
+#include "../circuitcore.h"
+#include <deque>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+struct TestCase {
+    std::string name;
+    std::function<void()> run;
+};
+
+// records a failure of the running case; returns `ok`
+bool TestCheck(bool ok, const char* expr, const char* file, int line);
+
+#define CHECK(expr) TestCheck((expr), #expr, __FILE__, __LINE__)
+
+// every component by id
+typedef std::map<int, Component> PartMap;
+
+// the parts in componentsData
+PartMap CircuitParts();
+// componentsData, both member lists (order and handles) and the running
+// sums agree with each other
+void CheckCircuit();
+// the same, and the parts are exactly `expected`
+void CheckCircuitIs(const PartMap& expected);
+
+// what the journal should do, as whole circuit states: undo goes back to
+// the state before the newest edit, redo forward again
+struct EditModel {
+    PartMap parts;
+    std::deque<PartMap> undo;       // oldest first, at most MAX_UNDO_STEPS
+    std::vector<PartMap> redo;
+
+    void Edited(const PartMap& before) {
+        undo.push_back(before);
+        if (undo.size() > MAX_UNDO_STEPS) undo.pop_front();
+        redo.clear();
+    }
+    void Undo() {
+        if (undo.empty()) return;
+        redo.push_back(parts);
+        parts = undo.back();
+        undo.pop_back();
+    }
+    void Redo() {
+        if (redo.empty()) return;
+        undo.push_back(parts);
+        parts = redo.back();
+        redo.pop_back();
+    }
+};
+
+CircuitType RandomCircuit(std::mt19937& rng);
+
+void AddStoreTests(std::vector<TestCase>& cases);
+void AddEditTests(std::vector<TestCase>& cases);
+void AddTransactionTests(std::vector<TestCase>& cases);
+void AddSnapshotTests(std::vector<TestCase>& cases);
+void AddSpiceTests(std::vector<TestCase>& cases);
+void AddAllocTests(std::vector<TestCase>& cases);
+
+int RunTests(int argc, char** argv, const std::vector<TestCase>& cases);
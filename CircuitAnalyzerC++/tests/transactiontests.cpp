@@ -0,0 +1,135 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - bulk edit and transaction tests
+ ********************************************************************/
+
+#include "tests.h"
+
+static bool SameIds(const PartMap& a, const PartMap& b) {
+    if (a.size() != b.size()) return false;
+    for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+        if (i->first != j->first) return false;
+    }
+    return true;
+}
+
+// one random edit inside the open transaction, mirrored in `parts`
+static void TransactionStep(std::mt19937& rng, PartMap& parts, int depth) {
+    int op = (int)(rng() % 8);
+    if (op <= 1) {
+        int id = nextId;
+        CircuitType circuit = RandomCircuit(rng);
+        double value = 1.0 + rng() % 50;
+        AddComponent(ComponentType::INDUCTOR, value, circuit);
+        parts.emplace(id, Component(id, ComponentType::INDUCTOR, value, circuit));
+    }
+    else if (op <= 3) {
+        // often one added a moment ago, which then leaves no trace
+        int id = (op == 2) ? nextId - 1 - (int)(rng() % 3) : 1 + (int)(rng() % (unsigned)nextId);
+        CHECK(RemoveComponent(id) == (parts.erase(id) == 1));
+    }
+    else if (op == 4) {
+        ComponentSpec specs[5];
+        int count = (int)(rng() % 5);
+        for (int k = 0; k < count; ++k) specs[k] = { ComponentType::RESISTOR, 2.0 + k, RandomCircuit(rng) };
+        int first = AddComponents(specs, count);
+        for (int k = 0; k < count; ++k) parts.emplace(first + k, Component(first + k, specs[k].type, specs[k].value, specs[k].circuit));
+    }
+    else if (op == 5) {
+        int first = 1 + (int)(rng() % (unsigned)nextId);
+        int last = first + (int)(rng() % 10);
+        int removed = 0;
+        for (auto it = parts.lower_bound(first); it != parts.end() && it->first <= last; ++removed) it = parts.erase(it);
+        CHECK(RemoveComponents(first, last) == removed);
+    }
+    else if (op == 6) {
+        Undo();   // no-ops inside a transaction
+        Redo();
+    }
+    else if (depth < 2) {
+        BeginTransaction();   // joins the open one
+        for (int k = 0; k < 3; ++k) TransactionStep(rng, parts, depth + 1);
+        CommitTransaction("inner");
+    }
+}
+
+// transactions of random edits, each one journal entry (none when every
+// part it touched was added inside it), mixed with undo/redo runs
+static void TransactionModelCheck(unsigned seed) {
+    std::mt19937 rng(seed);
+    EditModel model;
+    for (int i = 0; i < 200; ++i) AppendComponent(ComponentType::CAPACITOR, 1e-6 * (1 + i % 7), RandomCircuit(rng));
+    model.parts = CircuitParts();
+
+    for (int step = 0; step < 1500; ++step) {
+        if (rng() % 3 == 0) {
+            int runs = 1 + (int)(rng() % 4);
+            bool back = (rng() & 1) != 0;
+            for (int k = 0; k < runs; ++k) {
+                if (back) { Undo(); model.Undo(); }
+                else { Redo(); model.Redo(); }
+            }
+        }
+        else {
+            PartMap before = CircuitParts();
+            PartMap parts = before;
+            size_t journal = undoJournal.size();
+            BeginTransaction();
+            int edits = 1 + (int)(rng() % 12);
+            for (int k = 0; k < edits; ++k) TransactionStep(rng, parts, 0);
+            CommitTransaction((rng() & 1) ? "tx" : nullptr);
+            CHECK(SameIds(CircuitParts(), parts));
+            if (!SameIds(before, parts)) model.Edited(before);
+            else CHECK(undoJournal.size() == journal);
+            model.parts = CircuitParts();
+        }
+        CheckCircuitIs(model.parts);
+        CHECK(undoJournal.size() == model.undo.size() && redoStack.size() == model.redo.size());
+    }
+    while (!model.undo.empty()) { Undo(); model.Undo(); CheckCircuitIs(model.parts); }
+    while (!model.redo.empty()) { Redo(); model.Redo(); CheckCircuitIs(model.parts); }
+}
+
+// 200k parts added and removed again in one transaction: no journal entry,
+// and linear time (erasing each from the transaction's list was quadratic)
+static void TransactionAddThenRemove() {
+    AddComponent(ComponentType::RESISTOR, 1.0, CircuitType::SERIES);
+    PartMap before = CircuitParts();
+    size_t journal = undoJournal.size();
+    size_t log = opQueue.size();
+
+    const int count = 200000;
+    std::mt19937 rng(3);
+    BeginTransaction();
+    int first = nextId;
+    for (int i = 0; i < count; ++i) AddComponent(ComponentType::RESISTOR, 1.0 + i, RandomCircuit(rng));
+    for (int i = 0; i < count; ++i) RemoveComponent(first + i);
+    CommitTransaction();
+
+    CHECK(undoJournal.size() == journal && opQueue.size() == log);
+    CheckCircuitIs(before);
+
+    // half of them kept: one entry holding exactly those
+    BeginTransaction();
+    first = nextId;
+    for (int i = 0; i < 1000; ++i) AddComponent(ComponentType::RESISTOR, 1.0 + i, CircuitType::PARALLEL);
+    for (int i = 0; i < 1000; i += 2) RemoveComponent(first + i);
+    RemoveComponent(1);
+    CommitTransaction();
+    CHECK(undoJournal.size() == journal + 1 && undoJournal.back().batch);
+    if (undoJournal.back().batch) {
+        CHECK(undoJournal.back().batch->added.size() == 500 && undoJournal.back().batch->removed.size() == 1);
+    }
+    CHECK(parallelCircuit.size() == 500 && seriesCircuit.empty());
+    Undo();
+    CheckCircuitIs(before);
+    Redo();
+    CHECK(parallelCircuit.size() == 500 && FindComponent(1) == nullptr);
+    CheckCircuit();
+}
+
+void AddTransactionTests(std::vector<TestCase>& cases) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        cases.push_back({ "TransactionModel/" + std::to_string(seed), [seed] { TransactionModelCheck(seed); } });
+    }
+    cases.push_back({ "TransactionAddThenRemove", TransactionAddThenRemove });
+}
@@ -0,0 +1,287 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - transient (time-domain) simulation
+ ********************************************************************/
+
+#include "transient.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// rows buffered before a write; the only per-step memory
+const int TRANSIENT_CHUNK = 4096;
+// step level used from t = 0 and after every source corner
+const int TRANSIENT_RESTART_HALVINGS = 10;
+// accepted steps with a small error before the step is doubled
+const int TRANSIENT_GROW_AFTER = 4;
+
+bool TransientSettingsValid(const TransientSettings& s) {
+    const TransientSource& src = s.source;
+    return s.stopTime > 0.0 && s.maxStep > 0.0 && s.maxHalvings >= 0 && s.maxHalvings <= 40 &&
+        s.relTol > 0.0 && s.absTol > 0.0 && src.seriesR > 0.0 && src.delay >= 0.0 &&
+        src.rise >= 0.0 && src.fall >= 0.0 && src.width >= 0.0 && src.period >= 0.0;
+}
+
+static bool SourceNeverFalls(const TransientSource& src) {
+    return src.width == 0.0 && src.period == 0.0;
+}
+
+double TransientSourceAt(const TransientSource& src, double t) {
+    if (t < src.delay) return src.v1;
+    double u = t - src.delay;
+    if (src.period > 0.0) u = std::fmod(u, src.period);
+    if (u < src.rise) return src.v1 + (src.v2 - src.v1) * (u / src.rise);
+    u -= src.rise;
+    if (SourceNeverFalls(src) || u < src.width) return src.v2;
+    u -= src.width;
+    if (u < src.fall) return src.v2 + (src.v1 - src.v2) * (u / src.fall);
+    return src.v1;
+}
+
+// first corner of the source waveform after t (infinity if none)
+static double NextSourceCorner(const TransientSource& src, double t, double eps) {
+    const double corners[4] = { 0.0, src.rise, src.rise + src.width, src.rise + src.width + src.fall };
+    int count = SourceNeverFalls(src) ? 2 : 4;
+    double base = src.delay;
+    if (src.period > 0.0 && t > src.delay) base += std::floor((t - src.delay) / src.period) * src.period;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int c = 0; c < count; ++c) {
+            if (base + corners[c] > t + eps) return base + corners[c];
+        }
+        if (src.period <= 0.0) break;
+        base += src.period;
+    }
+    return INFINITY;
+}
+
+// ---------------------- Companion Models -------------------------
+
+// per element for one step h: i(a->b) = g * v(a,b) + ieq
+struct TransientState {
+    std::vector<cd> g;             // as admittances, for AssembleNodalMatrix
+    std::vector<double> ieq;
+    std::vector<double> vPrev;     // element voltage and current at the last accepted step
+    std::vector<double> iPrev;
+    double factoredH = 0.0;
+    TransientMethod factoredMethod = TransientMethod::TRAPEZOIDAL;
+};
+
+static double CompanionConductance(const Component& c, double h, TransientMethod m) {
+    double k = (m == TransientMethod::TRAPEZOIDAL) ? 2.0 : 1.0;
+    switch (c.type) {
+    case ComponentType::RESISTOR: return c.value != 0.0 ? 1.0 / c.value : 1e12;
+    case ComponentType::CAPACITOR: return k * c.value / h;
+    case ComponentType::INDUCTOR: return h / (k * c.value);
+    }
+    return 0.0;
+}
+
+static bool FactorForStep(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws, TransientState& st,
+    const TransientSettings& settings, double h, TransientMethod m, TransientStats& stats) {
+    if (st.factoredH == h && st.factoredMethod == m) return true;
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        st.g[k] = CompanionConductance(net.elements[k].comp, h, m);
+    }
+    AssembleNodalMatrix(net, sym, ws, st.g.data());
+    ws.Ax[sym.diagSlot[net.inputNode - 1]] += 1.0 / settings.source.seriesR;
+    stats.factorizations++;
+    if (!FactorNodalMatrix(sym, ws)) return false;
+    st.factoredH = h;
+    st.factoredMethod = m;
+    return true;
+}
+
+// node voltages at t + h into v (v[0] = ground) for the factored step
+static void SolveStep(const Network& net, const MnaSymbolic& sym, MnaWorkspace& ws, TransientState& st,
+    const TransientSettings& settings, double tNext, TransientMethod m, std::vector<double>& v) {
+    std::fill(ws.X.begin(), ws.X.end(), cd(0.0, 0.0));
+    ws.X[sym.Pinv[net.inputNode - 1]] = TransientSourceAt(settings.source, tNext) / settings.source.seriesR;
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        const NetElement& e = net.elements[k];
+        double g = st.g[k].real();
+        double ieq = 0.0;
+        if (e.comp.type == ComponentType::CAPACITOR) {
+            ieq = (m == TransientMethod::TRAPEZOIDAL) ? -(g * st.vPrev[k] + st.iPrev[k]) : -g * st.vPrev[k];
+        }
+        else if (e.comp.type == ComponentType::INDUCTOR) {
+            ieq = (m == TransientMethod::TRAPEZOIDAL) ? st.iPrev[k] + g * st.vPrev[k] : st.iPrev[k];
+        }
+        st.ieq[k] = ieq;
+        if (e.nodeA == e.nodeB || ieq == 0.0) continue;
+        if (e.nodeA > 0) ws.X[sym.Pinv[e.nodeA - 1]] -= ieq;
+        if (e.nodeB > 0) ws.X[sym.Pinv[e.nodeB - 1]] += ieq;
+    }
+    SolveFactored(sym, ws, ws.X.data());
+    v[0] = 0.0;
+    for (int i = 1; i <= sym.n; ++i) v[i] = ws.X[sym.Pinv[i - 1]].real();
+}
+
+static void AcceptStep(const Network& net, TransientState& st, const std::vector<double>& v) {
+    for (size_t k = 0; k < net.elements.size(); ++k) {
+        const NetElement& e = net.elements[k];
+        double vk = v[e.nodeA] - v[e.nodeB];
+        st.vPrev[k] = vk;
+        st.iPrev[k] = st.g[k].real() * vk + st.ieq[k];
+    }
+}
+
+// ---------------------- Error Control -------------------------
+
+// last accepted points, newest at [count - 1]
+struct TransientHistory {
+    int count = 0;
+    double t[3];
+    std::vector<double> v[3];
+
+    void Push(double time, const std::vector<double>& volts) {
+        if (count == 3) {
+            std::swap(v[0], v[1]);
+            std::swap(v[1], v[2]);
+            t[0] = t[1];
+            t[1] = t[2];
+            count = 2;
+        }
+        t[count] = time;
+        v[count] = volts;
+        count++;
+    }
+};
+
+// LTE of the step to tn relative to the tolerances (<= 1 is acceptable),
+// from the gap between the corrector and a predictor of matching order:
+// quadratic for trapezoidal (LTE ~ h^3 v'''/12), linear for backward
+// Euler (LTE ~ h^2 v''/2). -1 when there is not enough history yet.
+static double EstimateStepError(const TransientHistory& hist, const TransientSettings& settings,
+    TransientMethod m, double tn, const std::vector<double>& v) {
+    int order = (m == TransientMethod::TRAPEZOIDAL) ? 2 : 1;
+    if (hist.count < order + 1) return -1.0;
+
+    int base = hist.count - order - 1;
+    double ts[3], w[3];
+    double prod = 1.0;
+    for (int j = 0; j <= order; ++j) {
+        ts[j] = hist.t[base + j];
+        prod *= tn - ts[j];
+    }
+    for (int j = 0; j <= order; ++j) {   // Lagrange weights at tn
+        w[j] = 1.0;
+        for (int l = 0; l <= order; ++l) {
+            if (l != j) w[j] *= (tn - ts[l]) / (ts[j] - ts[l]);
+        }
+    }
+    double h = tn - ts[order];
+    double scale = (m == TransientMethod::TRAPEZOIDAL) ? h * h * h / (2.0 * prod) : h * h / prod;
+
+    double worst = 0.0;
+    for (size_t i = 1; i < v.size(); ++i) {
+        double p = 0.0;
+        for (int j = 0; j <= order; ++j) p += w[j] * hist.v[base + j][i];
+        double tol = settings.relTol * std::max(std::fabs(v[i]), std::fabs(p)) + settings.absTol;
+        worst = std::max(worst, std::fabs(v[i] - p) * std::fabs(scale) / tol);
+    }
+    return worst;
+}
+
+// ---------------------- Output -------------------------
+
+struct TransientRow {
+    double t, source, vin, iin;
+};
+
+static void FlushRows(FILE* out, const std::vector<TransientRow>& rows, int count) {
+    for (int i = 0; i < count; ++i) {
+        const TransientRow& r = rows[i];
+        fprintf(out, "%.9g,%.6g,%.6g,%.6g\n", r.t, r.source, r.vin, r.iin);
+    }
+}
+
+// ---------------------- Simulation -------------------------
+
+bool WriteTransientCsv(FILE* out, const Network& net, const TransientSettings& settings, TransientStats& stats) {
+    stats = TransientStats();
+    if (!TransientSettingsValid(settings)) return false;
+    MnaSymbolic sym;
+    if (!AnalyzeNetwork(net, sym)) return false;
+    MnaWorkspace ws;
+    PrepareWorkspace(sym, ws);
+
+    size_t m = net.elements.size();
+    TransientState st;
+    st.g.assign(m, cd(0.0, 0.0));
+    st.ieq.assign(m, 0.0);
+    st.vPrev.assign(m, 0.0);
+    st.iPrev.assign(m, 0.0);
+
+    const TransientSource& src = settings.source;
+    const double eps = settings.maxStep * 1e-9;
+    const int restartLevel = std::min(settings.maxHalvings, TRANSIENT_RESTART_HALVINGS);
+    std::vector<double> v(sym.n + 1, 0.0);
+    TransientHistory hist;
+
+    std::vector<TransientRow> rows(TRANSIENT_CHUNK);
+    int pending = 0;
+    auto emit = [&](const TransientRow& row) {
+        rows[pending++] = row;
+        if (pending == TRANSIENT_CHUNK) {
+            FlushRows(out, rows, pending);
+            pending = 0;
+        }
+    };
+
+    fprintf(out, "time_s,source_v,vin_v,iin_a\n");
+    double t = 0.0;
+    hist.Push(t, v);
+    emit(TransientRow{ t, src.v1, 0.0, 0.0 });   // at rest, before the source acts
+
+    int level = restartLevel;
+    int calm = 0;                  // accepted steps in a row with a small error
+    bool ok = true;
+    while (t < settings.stopTime - eps) {
+        double target = std::min(NextSourceCorner(src, t, eps), settings.stopTime);
+        double h = std::ldexp(settings.maxStep, -level);
+        bool landing = t + h >= target - eps;
+        if (landing) h = target - t;
+        // one backward Euler step after every restart damps the trapezoidal
+        // rule's ringing on the corner and gives it consistent states
+        TransientMethod method = hist.count < 2 ? TransientMethod::BACKWARD_EULER : settings.method;
+
+        if (!FactorForStep(net, sym, ws, st, settings, h, method, stats)) {
+            ok = false;
+            break;
+        }
+        SolveStep(net, sym, ws, st, settings, t + h, method, v);
+
+        double err = EstimateStepError(hist, settings, method, t + h, v);
+        if (err > 1.0 && level < settings.maxHalvings) {
+            level++;
+            calm = 0;
+            stats.rejected++;
+            continue;
+        }
+
+        AcceptStep(net, st, v);
+        t = landing ? target : t + h;
+        stats.steps++;
+        double vs = TransientSourceAt(src, t);
+        emit(TransientRow{ t, vs, v[net.inputNode], (vs - v[net.inputNode]) / src.seriesR });
+
+        if (landing && target < settings.stopTime) {
+            hist.count = 0;
+            level = restartLevel;
+            calm = 0;
+        }
+        else if (err < 0.1) {
+            if (++calm >= TRANSIENT_GROW_AFTER && level > 0) {
+                level--;
+                calm = 0;
+            }
+        }
+        else {
+            calm = 0;
+        }
+        hist.Push(t, v);
+    }
+
+    FlushRows(out, rows, pending);
+    stats.endTime = t;
+    return ok && !ferror(out);
+}
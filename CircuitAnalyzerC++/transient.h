@@ -0,0 +1,65 @@
+/********************************************************************
+ * Electronic Circuit Analyzer - transient (time-domain) simulation
+ *
+ * Step and pulse responses of a Network driven at its input node by a
+ * voltage source with a series resistance (Norton form, so the nodal
+ * matrix stays symmetric and reuses the MNA ordering and LDL^T).
+ *
+ * Every L and C becomes a companion model for one step h: a conductance
+ * plus a history current source, from the trapezoidal rule or backward
+ * Euler. The matrix depends only on h, so it is factored once per step
+ * size and each step is a right-hand side and two triangular solves.
+ *
+ * The step is adapted from a local truncation error estimate (corrector
+ * minus a polynomial predictor). Step sizes are powers of two below
+ * maxStep so they repeat and the factorization is reused; the source's
+ * corners are hit exactly and restart with backward Euler. Rows are
+ * written to the CSV in fixed chunks, so memory stays O(nodes) however
+ * many steps are taken.
+ ********************************************************************/
+
+#pragma once
+
+#include "mna.h"
+#include <cstdio>
+
+enum class TransientMethod { TRAPEZOIDAL = 0, BACKWARD_EULER = 1 };
+
+// v1 before `delay`, then ramps to v2 in `rise`, holds `width`, falls back
+// in `fall`; repeats every `period` when it is > 0 (SPICE PULSE). A step is
+// a pulse that never falls (width 0 = forever).
+struct TransientSource {
+    double v1 = 0.0;
+    double v2 = 1.0;
+    double delay = 0.0;
+    double rise = 0.0;
+    double fall = 0.0;
+    double width = 0.0;
+    double period = 0.0;
+    double seriesR = 1e-3;     // source resistance in Ohm
+};
+
+struct TransientSettings {
+    double stopTime = 1e-3;
+    double maxStep = 1e-6;
+    int maxHalvings = 20;      // smallest step = maxStep / 2^maxHalvings
+    double relTol = 1e-3;
+    double absTol = 1e-6;      // V
+    TransientMethod method = TransientMethod::TRAPEZOIDAL;
+    TransientSource source;
+};
+
+struct TransientStats {
+    long long steps = 0;
+    long long rejected = 0;
+    long long factorizations = 0;
+    double endTime = 0.0;
+};
+
+bool TransientSettingsValid(const TransientSettings& s);
+double TransientSourceAt(const TransientSource& src, double t);
+
+// simulates from rest (capacitors discharged, no inductor current) and
+// streams "time_s,source_v,vin_v,iin_a" rows; false on bad settings or a
+// singular network
+bool WriteTransientCsv(FILE* out, const Network& net, const TransientSettings& settings, TransientStats& stats);